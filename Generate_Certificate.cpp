@@ -1,82 +1,17 @@
-#include "crypto_headers.h"
-// Function to convert an Integer to a string representation
-std::string IntegerToString(const CryptoPP::Integer& integer) {
-    std::ostringstream oss;
-    oss << integer; // Convert to decimal string
-    return oss.str();
-}
-`
-// Function to load an Integer from a binary file
-void LoadIntegersFromFile(const std::string& filename, CryptoPP::Integer& p) {
-    // Open the file for binary reading
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Error opening file for reading: " << filename << std::endl;
-        return;
-    }
-
-    // Read size and data
-    size_t size;
-    file.read(reinterpret_cast<char*>(&size), sizeof(size_t));
-    std::string pStr(size, 0);
-    file.read(&pStr[0], size);
-    p.Decode(reinterpret_cast<const CryptoPP::byte*>(pStr.data()), size);
-
-    file.close();
-}
-
-// Function to encode data to Base64 format
-std::string Base64Encode(const std::string& input) {
-    std::string encoded;
-    CryptoPP::StringSource ss(input, true, new CryptoPP::Base64Encoder(new CryptoPP::StringSink(encoded)));
-    return encoded;
-}
-
-// Function to load a DSA private key from a file
-void LoadDSAPrivateKey(const std::string& filename, CryptoPP::DSA::PrivateKey& key) {
-    try {
-        CryptoPP::FileSource file(filename.c_str(), true);
-        key.Load(file);
-    } catch (const CryptoPP::Exception& e) {
-        std::cerr << "Error loading DSA private key: " << e.what() << std::endl;
-        throw;
-    }
-}
+#include "certificate.h"
+#include "issuance_pipeline.h"
+#include "key_store.h"
 
 // Function to generate a certificate for Alice or Bob
-std::string GenerateCertificate(const std::string& publicKeyFile, const CryptoPP::DSA::PrivateKey& caPrivKey) {
+std::string GenerateCertificate(const std::string& publicKeyFile, const CryptoPP::DSA::PrivateKey& caPrivKey, bool binary) {
     // Load the public key from the file
     CryptoPP::Integer p;
-    LoadIntegersFromFile(publicKeyFile, p);
-
-    // Prepare the certificate data
-    std::string certData = "Signature Algorithm: DSA\nSubject PublicKey:\n" + IntegerToString(p);
-
-    // Hash the certificate data using SHA-256
-    std::string hash;
-    try {
-        CryptoPP::SHA256 hashFunction;
-        CryptoPP::StringSource(certData, true, new CryptoPP::HashFilter(hashFunction, new CryptoPP::StringSink(hash)));
-    } catch (const CryptoPP::Exception& e) {
-        std::cerr << "Error hashing certificate data: " << e.what() << std::endl;
-        throw;
-    }
-
-    // Sign the hash using the DSA private key
-    std::string signature;
-    try {
-        CryptoPP::AutoSeededRandomPool rng;
-        CryptoPP::DSA::Signer signer(caPrivKey);
-        CryptoPP::StringSource(hash, true, new CryptoPP::SignerFilter(rng, signer, new CryptoPP::StringSink(signature)));
-    } catch (const CryptoPP::Exception& e) {
-        std::cerr << "Error signing hash: " << e.what() << std::endl;
-        throw;
-    }
-
-    // Prepare the final certificate string
-    std::string certificate = certData + "\nSignature:\n" + Base64Encode(signature);
+    LoadIntegerFromFile(publicKeyFile, p);
 
-    return certificate;
+    // Hash the certificate data with SHA-256 and sign the hash with the CA key
+    CryptoPP::AutoSeededRandomPool rng;
+    CryptoPP::DSA::Signer signer(caPrivKey);
+    return binary ? IssueBinaryCertificate(p, signer, rng) : IssueCertificate(p, signer, rng);
 }
 
 // Function to save the certificate to a file
@@ -91,15 +26,144 @@ void SaveCertificate(const std::string& filename, const std::string& certificate
     }
 }
 
+// Function to issue a certificate for every public key in a manifest
+// (one "<public_key_file> <certificate_file>" pair per line) through the
+// issuance pipeline, with the CA key loaded once
+int IssueBulk(const std::string& manifestFile, unsigned int threads, bool binary, const std::string& containerFile,
+              bool compare) {
+    try {
+        std::ifstream manifest(manifestFile);
+        if (!manifest) {
+            throw std::runtime_error("Unable to open file: " + manifestFile);
+        }
+        std::vector<IssuanceJob> jobs;
+        std::string line;
+        while (std::getline(manifest, line)) {
+            std::istringstream fields(line);
+            IssuanceJob job;
+            if (!(fields >> job.publicKeyFile)) {
+                continue;
+            }
+            // The output column may be left out when everything goes into a container
+            if (!(fields >> job.certificateFile) && containerFile.empty()) {
+                throw std::runtime_error("Manifest line has no certificate file: " + line);
+            }
+            jobs.push_back(job);
+        }
+        if (jobs.empty()) {
+            throw std::runtime_error("Manifest lists no public keys");
+        }
+
+        CryptoPP::DSA::PrivateKey caDSAPrivKey;
+        LoadDSAPrivateKey("CA_Priv.bin", caDSAPrivKey);
+
+        // The threads are split between the stages rather than added per
+        // stage. g^k is the expensive part, so the nonce producers get
+        // three quarters and the signers, which only do mod-q arithmetic,
+        // the rest. With one thread the signer computes its nonces inline.
+        IssuanceOptions options;
+        options.signerThreads = std::max(1u, threads / 4);
+        if (threads > options.signerThreads) {
+            options.pool.refillThreads = threads - options.signerThreads;
+        } else {
+            options.pool.depth = 0;
+        }
+        options.binary = binary;
+        options.container = containerFile;
+
+        auto setupStart = std::chrono::steady_clock::now();
+        IssuancePipeline pipeline(caDSAPrivKey, options);
+        auto setupEnd = std::chrono::steady_clock::now();
+
+        IssuanceReport report;
+        pipeline.Run(jobs, report);
+
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (!report.errors[i].empty()) {
+                std::cerr << jobs[i].publicKeyFile << ": " << report.errors[i] << std::endl;
+            }
+        }
+        SigningStats signing = pipeline.Engine().Stats();
+        std::cout << "Issued " << report.issued << "/" << jobs.size() << " certificates in " << report.seconds
+                  << " s (" << (report.seconds > 0 ? report.issued / report.seconds : 0.0) << " certificates/s, "
+                  << (options.pool.depth > 0 ? options.pool.refillThreads : 0) << " nonce threads, " << options.signerThreads << " signer threads, setup "
+                  << std::chrono::duration<double, std::milli>(setupEnd - setupStart).count() << " ms)" << std::endl;
+        std::cout << "Stage busy time: read " << report.readSeconds << " s, sign " << report.signSeconds
+                  << " s, write " << report.writeSeconds << " s; " << signing.pooled << " pooled nonces, "
+                  << signing.inlined << " computed inline" << std::endl;
+
+        if (compare) {
+            // The original path: CA key reloaded, a new Signer and RNG and
+            // an inline g^k for every certificate; nothing is written
+            auto singleStart = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < jobs.size(); i++) {
+                if (report.errors[i].empty()) {
+                    CryptoPP::DSA::PrivateKey key;
+                    LoadDSAPrivateKey("CA_Priv.bin", key);
+                    GenerateCertificate(jobs[i].publicKeyFile, key, binary);
+                }
+            }
+            double singleSeconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - singleStart).count();
+            std::cout << "One-at-a-time path: " << singleSeconds << " s ("
+                      << (singleSeconds > 0 ? report.issued / singleSeconds : 0.0)
+                      << " certificates/s), pipeline speedup "
+                      << (report.seconds > 0 ? singleSeconds / report.seconds : 0.0) << "x" << std::endl;
+        }
+
+        return report.issued == jobs.size() ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
 int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    // Flags may follow either form
+    bool binary = false, compare = false;
+    std::string containerFile;
+    for (size_t i = 0; i < args.size();) {
+        if (args[i] == "--binary") {
+            binary = true;
+        } else if (args[i] == "--compare") {
+            compare = true;
+        } else if (args[i] == "--container" && i + 1 < args.size()) {
+            containerFile = args[i + 1];
+            args.erase(args.begin() + i);
+        } else {
+            i++;
+            continue;
+        }
+        args.erase(args.begin() + i);
+    }
+
+    if ((args.size() == 2 || args.size() == 3) && args[0] == "--bulk") {
+        // A malformed thread count falls through to the usage message
+        unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+        bool validThreads = true;
+        if (args.size() == 3) {
+            try {
+                threads = unsigned(std::max<unsigned long>(1, std::stoul(args[2])));
+            } catch (const std::logic_error&) {
+                validThreads = false;
+            }
+        }
+        if (validThreads) {
+            return IssueBulk(args[1], threads, binary, containerFile, compare);
+        }
+    }
+
     // Ensure proper usage
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <Alice|Bob>" << std::endl;
+    if (args.size() != 1 || compare || !containerFile.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <Alice|Bob> [--binary]" << std::endl;
+        std::cerr << "       " << argv[0] << " --bulk <manifest_file> [threads] [--binary] [--container <file>] [--compare]" << std::endl;
         return 1;
     }
 
     // Determine if the user is Alice or Bob
-    std::string user = argv[1];
+    std::string user = args[0];
     std::string publicKeyFile;
     std::string certificateFile;
 
@@ -120,19 +184,21 @@ int main(int argc, char* argv[]) {
         LoadDSAPrivateKey("CA_Priv.bin", caDSAPrivKey);
 
         // Generate the certificate for the user
-        std::string certificate = GenerateCertificate(publicKeyFile, caDSAPrivKey);
+        std::string certificate = GenerateCertificate(publicKeyFile, caDSAPrivKey, binary);
 
         // Save the certificate to a file
         SaveCertificate(certificateFile, certificate);
 
         std::cout << "Certificate for " << user << " generated and saved successfully!" << std::endl;
-    } catch (const CryptoPP::Exception& e) {
+    } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
 
     return 0;
 }
-// g++ -o test Generate_Certificate.cpp -lcryptopp -lpthread
+// g++ -O2 -o test Generate_Certificate.cpp certificate.cpp certificate_stream.cpp certificate_signer.cpp issuance_pipeline.cpp fixed_base.cpp mod_exp.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp -lpthread
 // ./test Alice
 // ./test Bob
+// ./test Alice --binary
+// ./test --bulk fleet.txt 8 --compare
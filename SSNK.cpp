@@ -1,174 +1,121 @@
-#include "crypto_headers.h"
+#include "key_agreement.h"
+#include "session_kdf.h"
+#include "certificate.h"
+#include "certificate_cache.h"
+#include "key_store.h"
+#include "metrics.h"
 
 using namespace CryptoPP;
 
-// Function to perform modular exponentiation
-Integer ModExp(const Integer& base, const Integer& exponent, const Integer& modulus) {
-    Integer result = 1;
-    Integer b = base % modulus;
-    Integer e = exponent;
-    
-    while (e > 0) {
-        if (e.GetBit(0)) {
-            result = (result * b) % modulus;
-        }
-        e >>= 1;
-        b = (b * b) % modulus;
-    }
-    return result;
-}
-
-// Function to load integers from a binary file
-void LoadIntegersFromFile(const std::string& filename, Integer& p, Integer& q, Integer& g) {
-    // Open file for binary reading
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Error opening file for reading: " << filename << std::endl;
-        return;
-    }
-
-    // Read sizes and data
-    size_t size;
-    
-    // Read p
-    file.read(reinterpret_cast<char*>(&size), sizeof(size_t));
-    std::string pStr(size, 0);
-    file.read(&pStr[0], size);
-    p.Decode(reinterpret_cast<const byte*>(pStr.data()), size);
-
-    // Read q
-    file.read(reinterpret_cast<char*>(&size), sizeof(size_t));
-    std::string qStr(size, 0);
-    file.read(&qStr[0], size);
-    q.Decode(reinterpret_cast<const byte*>(qStr.data()), size);
-
-    // Read g
-    file.read(reinterpret_cast<char*>(&size), sizeof(size_t));
-    std::string gStr(size, 0);
-    file.read(&gStr[0], size);
-    g.Decode(reinterpret_cast<const byte*>(gStr.data()), size);
-
-    file.close();
-}
-
-// Function to read certificate file
-std::string ReadFile(const std::string& filename) {
-    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
-    if (!file) {
-        throw std::runtime_error("Unable to open file: " + filename);
+// Verified peer certificates kept in a --cache file
+static const size_t kCacheCapacity = 1024;
+
+// Function to get the peer's public key through the verified-certificate
+// cache: a hit skips parsing and verification, a miss verifies the
+// certificate against the CA key and records it. The file is only
+// rewritten when a new certificate was added.
+Integer CachedPeerKey(const std::string& certificate, const std::string& cacheFile, const std::string& caPubKeyFile) {
+    // The cache file is bound to the CA key, so entries verified against
+    // another CA are never accepted
+    DSA::PublicKey caPublicKey;
+    LoadDSAPublicKey(caPubKeyFile, caPublicKey);
+    CertificateDigest authority = CertificateCache::AuthorityDigest(caPublicKey);
+    CertificateCache cache(kCacheCapacity);
+    cache.Load(cacheFile, authority);
+
+    Integer peerKey = cache.GetOrVerify(certificate, [&](const std::string& cert) {
+        DSA::Verifier verifier(caPublicKey);
+        return VerifyCertificateSignature(cert, verifier);
+    });
+
+    if (cache.Modified()) {
+        cache.Save(cacheFile, authority);
     }
-    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    return content;
+    return peerKey;
 }
 
-// Function to extract data and signature from certificate
-void ExtractDataAndSignature(const std::string& certificate, std::string& data, std::string& signature) {
-    std::string delimiter = "\nSignature:\n";
-    size_t pos = certificate.find(delimiter);
-    if (pos == std::string::npos) {
-        throw std::runtime_error("Invalid certificate format");
-    }
-    data = certificate.substr(0, pos);
-    signature = certificate.substr(pos + delimiter.length());
-}
-
-// Function to extract the public key from the given string
-Integer ExtractPublicKey(const std::string& input) {
-    std::string keyString;
-
-    // Find the part of the input that contains the public key
-    std::string::size_type startPos = input.find("Subject PublicKey:");
-    if (startPos != std::string::npos) {
-        // Move past the label "Subject PublicKey:"
-        startPos += std::strlen("Subject PublicKey:");
-
-        // Extract the public key part
-        std::string::size_type endPos = input.find_first_of("0123456789", startPos);
-        if (endPos != std::string::npos) {
-            keyString = input.substr(endPos);
-
-            // Trim any leading or trailing whitespace
-            keyString.erase(0, keyString.find_first_not_of(" \n\r\t"));
-            keyString.erase(keyString.find_last_not_of(" \n\r\t") + 1);
-
-            // Convert the decimal string to CryptoPP::Integer
-            return Integer(keyString.c_str());
+int main(int argc,char* argv[]){
+    std::string groupName = "modp";
+    std::string cacheFile, caPubKeyFile = "CA_Pub.bin";
+    std::vector<std::string> kdfSpecs;
+    bool raw = false;
+    bool validArgs = argc >= 4;
+    for (int i = 4; validArgs && i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--group" && i + 1 < argc) {
+            groupName = argv[++i];
+        } else if (option == "--kdf" && i + 1 < argc) {
+            kdfSpecs.push_back(argv[++i]);
+        } else if (option == "--raw") {
+            raw = true;
+        } else if (option == "--cache" && i + 1 < argc) {
+            cacheFile = argv[++i];
+            if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0) {
+                caPubKeyFile = argv[++i];
+            }
         } else {
-            throw std::runtime_error("Public key not found in the input string.");
+            validArgs = false;
         }
-    } else {
-        throw std::runtime_error("Public key label not found in the input string.");
-    }
-}
-
-void LoadPrivateKey(const std::string& filename, Integer& p) {
-    // Open file for binary reading
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Error opening file for reading: " << filename << std::endl;
-        return;
     }
-
-    // Read sizes and data
-    size_t size;
-    
-    // Read p
-    file.read(reinterpret_cast<char*>(&size), sizeof(size_t));
-    std::string pStr(size, 0);
-    file.read(&pStr[0], size);
-    p.Decode(reinterpret_cast<const byte*>(pStr.data()), size);
-
-    file.close();
-}
-
-void SaveIntegersToFile(const std::string& filename, const Integer& p) {
-    // Open file for binary writing
-    std::ofstream file(filename, std::ios::binary);
-    if (!file) {
-        std::cerr << "Error opening file for writing: " << filename << std::endl;
-        return;
-    }
-
-    // Serialize each Integer to a byte array
-    std::string pStr(p.MinEncodedSize(), 0);
-
-    p.Encode(reinterpret_cast<CryptoPP::byte*>(&pStr[0]), pStr.size());
-
-    // Write sizes followed by the data
-    size_t pSize = pStr.size();
-
-    file.write(reinterpret_cast<const char*>(&pSize), sizeof(size_t));
-    file.write(pStr.data(), pSize);
-
-    file.close();
-}
-
-
-int main(int argc,char* argv[]){
-    if (argc != 4) {
-        std::cerr << "Usage: " << argv[0] << " <certificate_file>" << std::endl;
+    if (!validArgs || (raw && !kdfSpecs.empty())) {
+        std::cerr << "Usage: " << argv[0] << " <certificate_file> <private_key_file> <session_key_file> [--cache <cache_file> [ca_pub_key_file]] [--group <group>] [--kdf <label>[:<bytes>]]... [--raw]" << std::endl;
         return 1;
     }
     std::string certFile = argv[1];
     std::string private_key = argv[2];
     std::string save_SSNK = argv[3];
-    Integer p, q, g;
-    // Load from file
-    LoadIntegersFromFile("params.bin", p, q, g);
-    // Read certificate
-    std::string certificate = ReadFile(certFile);
-        // Extract data and signature
-    std::string certData, signature;
-    ExtractDataAndSignature(certificate, certData, signature);
-    Integer Oth_pub_key=ExtractPublicKey(certData);
-    Integer alpha;
-    LoadPrivateKey(private_key,alpha);
-    Integer SSNK=ModExp(Oth_pub_key,alpha,p);
-    SaveIntegersToFile(save_SSNK,SSNK);
+    try {
+        // File reads, certificate checks and the exponentiation report their own timers
+        DH_METRIC_TIME("dh_session_key_tool_seconds", "Wall time of one sessionKeyGen run");
+        // The mod-p group loads p, q and g from params.bin
+        std::unique_ptr<KeyAgreementBackend> group = MakeKeyAgreementBackend(groupName);
+        // Read certificate
+        std::string certificate = ReadFile(certFile);
+        Integer Oth_pub_key;
+        if (!cacheFile.empty()) {
+            Oth_pub_key = CachedPeerKey(certificate, cacheFile, caPubKeyFile);
+        } else {
+            // Subject public key from a text or binary certificate
+            Oth_pub_key = CertificatePublicKey(certificate);
+        }
+        Integer alpha;
+        LoadIntegerFromFile(private_key,alpha);
+        SecByteBlock privateKey(group->PrivateKeyLength()), peerKey(group->PublicKeyLength());
+        SecByteBlock agreed(group->AgreedValueLength());
+        IntegerToKey(alpha, privateKey, privateKey.size());
+        IntegerToKey(Oth_pub_key, peerKey, peerKey.size());
+        if (!group->Agree(agreed, privateKey, peerKey)) {
+            throw std::runtime_error("Peer public key is not a valid " + group->Name() + " key");
+        }
+        if (raw) {
+            // The bare shared secret, as earlier versions wrote it
+            SaveIntegerToFile(save_SSNK, KeyToInteger(agreed, agreed.size()));
+        } else {
+            // Fixed-length keys, one per --kdf label in order
+            std::vector<KdfOutput> outputs;
+            for (const std::string& spec : kdfSpecs) {
+                outputs.push_back(ParseKdfOutput(spec));
+            }
+            if (outputs.empty()) {
+                outputs.push_back({kDefaultKdfLabel, kDefaultKdfLength});
+            }
+            SessionKdf kdf(outputs);
+            SecByteBlock keys(kdf.OutputLength());
+            kdf.Derive(agreed, agreed.size(), keys);
+            WriteFileBytes(save_SSNK, std::string(reinterpret_cast<const char*>(keys.data()), keys.size()));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
 }
 
-// g++ -o test SSNK.cpp -lcryptopp -lpthread
+// g++ -o test SSNK.cpp key_agreement.cpp named_groups.cpp certificate.cpp certificate_stream.cpp certificate_cache.cpp session_kdf.cpp fixed_base.cpp secret_exp.cpp mod_exp.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp -lpthread
 // ./test Certificate-A.bin privatekeyA.bin SSNKA.bin
 // ./test Certificate-B.bin privatekeyB.bin SSNKB.bin
+// ./test Certificate-A.bin privatekeyA.bin SSNKA.bin --cache cert_cache.dhc CA_Pub.bin
+// ./test Certificate-B.bin privatekeyA.bin SSNKA.bin --group x25519
+// ./test Certificate-B.bin privatekeyA.bin SSNKA.bin --kdf client_write:32 --kdf server_write:32 --kdf iv:12
 // md5sum SSNKA.bin
 // md5sum SSNKB.bin
\ No newline at end of file
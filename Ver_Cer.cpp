@@ -1,95 +1,211 @@
-#include "crypto_headers.h"     // ASN.1 encoding and decoding
+#include "certificate.h"
+#include "certificate_verifier.h"
 
 using namespace CryptoPP;
 
-// Function to load DSA public key from a file
-void LoadPublicKey(const std::string& filename, DSA::PublicKey& key) {
-    FileSource file(filename.c_str(), true);
-    key.Load(file);
-}
+// Verified certificates kept in a --cache file
+static const size_t kCacheCapacity = 1 << 16;
+
+// Function to verify certificate; with a cache file, a certificate that
+// verified before is accepted without checking the signature again
+bool VerifyCertificate(const std::string& certFile, const std::string& caPubKeyFile, const std::string& cacheFile) {
+    try {
+        // Read certificate
+        std::string certificate = ReadFile(certFile);
+
+        // Load CA public key; a cache file only counts for the key it was saved with
+        DSA::PublicKey caPublicKey;
+        LoadDSAPublicKey(caPubKeyFile, caPublicKey);
+
+        std::unique_ptr<CertificateCache> cache;
+        CertificateDigest authority;
+        Integer publicKey;
+        if (!cacheFile.empty()) {
+            authority = CertificateCache::AuthorityDigest(caPublicKey);
+            cache.reset(new CertificateCache(kCacheCapacity));
+            cache->Load(cacheFile, authority);
+            if (cache->Lookup(CertificateCache::Digest(certificate), publicKey)) {
+                std::cout << "Certificate verification successful (cached)." << std::endl;
+                return true;
+            }
+        }
+
+        // Hash the certificate data and verify the signature
+        DSA::Verifier verifier(caPublicKey);
+        if (!VerifyCertificateSignature(certificate, verifier)) {
+            std::cerr << "Signature verification failed." << std::endl;
+            return false;
+        }
 
-// Function to read certificate file
-std::string ReadFile(const std::string& filename) {
-    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
-    if (!file) {
-        throw std::runtime_error("Unable to open file: " + filename);
+        if (cache) {
+            cache->Insert(CertificateCache::Digest(certificate), CertificatePublicKey(certificate));
+            cache->Save(cacheFile, authority);
+        }
+
+        std::cout << "Certificate verification successful." << std::endl;
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return false;
     }
-    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    return content;
 }
 
-// Function to extract data and signature from certificate
-void ExtractDataAndSignature(const std::string& certificate, std::string& data, std::string& signature) {
-    std::string delimiter = "\nSignature:\n";
-    size_t pos = certificate.find(delimiter);
-    if (pos == std::string::npos) {
-        throw std::runtime_error("Invalid certificate format");
+// Function to check one certificate the single-shot way: reload the CA
+// key and build a DSA::Verifier for it
+bool VerifySingleShot(const std::string& certificate, const std::string& caPubKeyFile) {
+    try {
+        DSA::PublicKey caPublicKey;
+        LoadDSAPublicKey(caPubKeyFile, caPublicKey);
+        DSA::Verifier verifier(caPublicKey);
+        return VerifyCertificateSignature(certificate, verifier);
+    } catch (const std::exception&) {
+        return false;
     }
-    data = certificate.substr(0, pos);
-    signature = certificate.substr(pos + delimiter.length());
 }
 
-// Function to base64 decode a string
-std::string Base64Decode(const std::string& encoded) {
-    std::string decoded;
-    StringSource ss(encoded, true, new Base64Decoder(new StringSink(decoded)));
-    return decoded;
-}
+// Function to verify every certificate named in a list file (one path per
+// line, "-" for stdin) with the CA key loaded once and its tables shared
+// across threads
+int VerifyBatch(const std::string& listFile, const std::string& caPubKeyFile, unsigned int threads, bool compare,
+                const std::string& cacheFile) {
+    std::ifstream listStream;
+    if (listFile != "-") {
+        listStream.open(listFile);
+        if (!listStream) {
+            std::cerr << "Error: Unable to open file: " << listFile << std::endl;
+            return 1;
+        }
+    }
+    std::istream& list = listFile == "-" ? std::cin : listStream;
 
-// Function to verify certificate
-bool VerifyCertificate(const std::string& certFile, const std::string& caPubKeyFile) {
     try {
-        // Load CA public key
-        DSA::PublicKey caPublicKey;
-        LoadPublicKey(caPubKeyFile, caPublicKey);
+        std::vector<std::string> names, certificates;
+        std::string line;
+        while (std::getline(list, line)) {
+            if (line.empty()) {
+                continue;
+            }
+            names.push_back(line);
+            certificates.push_back(ReadFile(line));
+        }
 
-        // Read certificate
-        std::string certificate = ReadFile(certFile);
+        DSA::PublicKey caPublicKey;
+        LoadDSAPublicKey(caPubKeyFile, caPublicKey);
 
-        // Extract data and signature
-        std::string certData, signature;
-        ExtractDataAndSignature(certificate, certData, signature);
+        auto setupStart = std::chrono::steady_clock::now();
+        CertificateVerifier verifier(caPublicKey);
+        auto setupEnd = std::chrono::steady_clock::now();
 
-        // Base64 decode the signature
-        std::string decodedSignature = Base64Decode(signature);
+        std::unique_ptr<CertificateCache> cache;
+        CertificateDigest authority = CertificateCache::AuthorityDigest(caPublicKey);
+        if (!cacheFile.empty()) {
+            cache.reset(new CertificateCache(kCacheCapacity));
+            cache->Load(cacheFile, authority);
+        }
 
-        // Hash the certificate data
-        std::string hash;
-        SHA256 hashFunction;
-        StringSource(certData, true, new HashFilter(hashFunction, new StringSink(hash)));
+        std::vector<char> results;
+        auto start = std::chrono::steady_clock::now();
+        verifier.VerifyBatch(certificates, results, threads, cache.get());
+        auto end = std::chrono::steady_clock::now();
+
+        if (cache) {
+            CertificateCacheStats stats = cache->Stats();
+            std::cout << "Certificate cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+                      << stats.evictions << " evictions, " << stats.entries << " entries" << std::endl;
+            if (cache->Modified()) {
+                cache->Save(cacheFile, authority);
+            }
+        }
 
-        // Verify the signature
-        DSA::Verifier verifier(caPublicKey);
-        bool result = verifier.VerifyMessage(reinterpret_cast<const byte*>(hash.data()), hash.size(),
-                                             reinterpret_cast<const byte*>(decodedSignature.data()), decodedSignature.size());
+        size_t passed = 0;
+        for (size_t i = 0; i < names.size(); i++) {
+            if (results[i]) {
+                passed++;
+            } else {
+                std::cerr << names[i] << ": signature verification failed." << std::endl;
+            }
+        }
 
-        if (!result) {
-            std::cerr << "Signature verification failed." << std::endl;
-            return false;
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << "Verified " << passed << "/" << names.size() << " certificates on " << threads << " threads in "
+                  << seconds << " s (" << (seconds > 0 ? names.size() / seconds : 0.0) << " verifications/s, tables "
+                  << std::chrono::duration<double, std::milli>(setupEnd - setupStart).count() << " ms)" << std::endl;
+
+        if (compare) {
+            // The original path: CA key reloaded and a DSA::Verifier built per certificate
+            size_t disagreements = 0;
+            auto singleStart = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < certificates.size(); i++) {
+                if (VerifySingleShot(certificates[i], caPubKeyFile) != bool(results[i])) {
+                    std::cerr << names[i] << ": single-shot path disagrees" << std::endl;
+                    disagreements++;
+                }
+            }
+            auto singleEnd = std::chrono::steady_clock::now();
+            double singleSeconds = std::chrono::duration<double>(singleEnd - singleStart).count();
+            std::cout << "Single-shot path: " << singleSeconds << " s ("
+                      << (singleSeconds > 0 ? names.size() / singleSeconds : 0.0) << " verifications/s), batch speedup "
+                      << (seconds > 0 ? singleSeconds / seconds : 0.0) << "x" << std::endl;
+            if (disagreements) {
+                return 1;
+            }
         }
 
-        std::cout << "Certificate verification successful." << std::endl;
-        return true;
-    }
-    catch (const Exception& e) {
+        return passed == names.size() ? 0 : 1;
+    } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
-        return false;
+        return 1;
     }
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <certificate_file> <ca_pub_key_file>" << std::endl;
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    // --cache <file> may follow either form
+    std::string cacheFile;
+    auto cacheFlag = std::find(args.begin(), args.end(), "--cache");
+    if (cacheFlag != args.end() && cacheFlag + 1 != args.end()) {
+        cacheFile = *(cacheFlag + 1);
+        args.erase(cacheFlag, cacheFlag + 2);
+    }
+
+    if (args.size() >= 3 && args[0] == "--batch") {
+        bool compare = args.back() == "--compare";
+        if (compare) {
+            args.pop_back();
+        }
+        if (args.size() == 3 || args.size() == 4) {
+            // A malformed thread count falls through to the usage message
+            unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+            bool validThreads = true;
+            if (args.size() == 4) {
+                try {
+                    threads = unsigned(std::max<unsigned long>(1, std::stoul(args[3])));
+                } catch (const std::logic_error&) {
+                    validThreads = false;
+                }
+            }
+            if (validThreads) {
+                return VerifyBatch(args[1], args[2], threads, compare, cacheFile);
+            }
+        }
+    }
+
+    if (args.size() != 2) {
+        std::cerr << "Usage: " << argv[0] << " <certificate_file> <ca_pub_key_file> [--cache <cache_file>]" << std::endl;
+        std::cerr << "       " << argv[0] << " --batch <list_file|-> <ca_pub_key_file> [threads] [--compare] [--cache <cache_file>]" << std::endl;
         return 1;
     }
 
-    std::string certFile = argv[1];
-    std::string caPubKeyFile = argv[2];
+    std::string certFile = args[0];
+    std::string caPubKeyFile = args[1];
 
-    return VerifyCertificate(certFile, caPubKeyFile) ? 0 : 1;
+    return VerifyCertificate(certFile, caPubKeyFile, cacheFile) ? 0 : 1;
 }
 
-// g++ -o test Ver_Cer.cpp -lcryptopp -lpthread
+// g++ -O2 -o test Ver_Cer.cpp certificate.cpp certificate_stream.cpp certificate_verifier.cpp certificate_cache.cpp fixed_base.cpp mod_exp.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp -lpthread
 // ./test Certificate-A.bin CA_Pub.bin
 // ./test Certificate-B.bin CA_Pub.bin
-
+// ls Certificate-*.bin | ./test --batch - CA_Pub.bin 4 --compare
+// ./test Certificate-A.bin CA_Pub.bin --cache cert_cache.dhc
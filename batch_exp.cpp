@@ -0,0 +1,451 @@
+#include "batch_exp.h"
+#include "metrics.h"
+
+#include <immintrin.h>
+
+using namespace CryptoPP;
+
+// Limbs for the largest supported modulus: 4096 bits plus two bits of
+// headroom for the lazy reduction, in radix 2^52
+static const size_t kBatchMaxLimbs = 80;
+static const uint64_t kMask52 = (uint64_t(1) << 52) - 1;
+
+// One group of lanes handed to a kernel. Lane-major arrays are laid out
+// limb by limb, [limb][lane], so one load fetches limb j of every lane.
+struct BatchExpJob {
+    size_t limbs;
+    uint64_t k0;               // -n^-1 mod 2^52
+    const uint64_t* modulus;   // [limbs], shared by every lane
+    const uint64_t* r2;        // [limbs][lanes], R^2 mod n
+    const uint64_t* one;       // [limbs][lanes], the integer 1
+    const uint64_t* bases;     // [limbs][lanes], each below n
+    const uint64_t* exponents; // [ceil(exponentBits / 64)][lanes], 64-bit words
+    size_t exponentBits;
+    uint64_t* results;         // [limbs][lanes], each at most n
+    uint64_t* table;           // [entries][limbs][lanes] scratch
+    uint64_t* selected;        // [limbs][lanes] scratch
+};
+
+// Lane policies. Each supplies a register type holding one 64-bit word per
+// lane and the handful of operations the kernel needs, with MulAdd52
+// adding the low and high 52-bit halves of a 52x52-bit product into two
+// accumulators. Member functions carry their instruction set in a target
+// attribute so the file builds without -mavx2 or -mavx512ifma; the
+// flattened entry points below pull them into one body per policy.
+struct PortableLanes {
+    static const size_t kLanes = 4;
+    struct Reg { uint64_t v[kLanes]; };
+    typedef Reg Mask;
+
+    static Reg Zero() { return Broadcast(0); }
+    static Reg Broadcast(uint64_t x) {
+        Reg r;
+        for (size_t l = 0; l < kLanes; l++) r.v[l] = x;
+        return r;
+    }
+    static Reg Load(const uint64_t* p) {
+        Reg r;
+        for (size_t l = 0; l < kLanes; l++) r.v[l] = p[l];
+        return r;
+    }
+    static void Store(uint64_t* p, const Reg& a) {
+        for (size_t l = 0; l < kLanes; l++) p[l] = a.v[l];
+    }
+    static Reg Add(const Reg& a, const Reg& b) {
+        Reg r;
+        for (size_t l = 0; l < kLanes; l++) r.v[l] = a.v[l] + b.v[l];
+        return r;
+    }
+    static Reg And(const Reg& a, const Reg& b) {
+        Reg r;
+        for (size_t l = 0; l < kLanes; l++) r.v[l] = a.v[l] & b.v[l];
+        return r;
+    }
+    static Reg ShiftRight(const Reg& a, unsigned int bits) {
+        Reg r;
+        for (size_t l = 0; l < kLanes; l++) r.v[l] = a.v[l] >> bits;
+        return r;
+    }
+    static Reg Low52(const Reg& a) { return And(a, Broadcast(kMask52)); }
+    static Reg High52(const Reg& a) { return ShiftRight(a, 52); }
+    static void MulAdd52(Reg& lo, Reg& hi, const Reg& a, const Reg& b) {
+        for (size_t l = 0; l < kLanes; l++) {
+            unsigned __int128 product = (unsigned __int128)a.v[l] * b.v[l];
+            lo.v[l] += uint64_t(product) & kMask52;
+            hi.v[l] += uint64_t(product >> 52);
+        }
+    }
+    static Reg MulLow52(const Reg& a, const Reg& b) {
+        Reg r;
+        for (size_t l = 0; l < kLanes; l++) r.v[l] = (a.v[l] * b.v[l]) & kMask52;
+        return r;
+    }
+    static Mask Equal(const Reg& a, uint64_t x) {
+        Mask m;
+        for (size_t l = 0; l < kLanes; l++) {
+            uint64_t diff = a.v[l] ^ x;
+            m.v[l] = ((diff | (0 - diff)) >> 63) - 1;
+        }
+        return m;
+    }
+    static Reg Blend(const Reg& current, const Reg& candidate, const Mask& m) {
+        Reg r;
+        for (size_t l = 0; l < kLanes; l++) r.v[l] = (candidate.v[l] & m.v[l]) | (current.v[l] & ~m.v[l]);
+        return r;
+    }
+};
+
+#define BATCH_AVX2 __attribute__((target("avx2")))
+
+// AVX2 has no 52-bit multiply, so each product is assembled from four
+// 26x26-bit _mm256_mul_epu32 products
+struct Avx2Lanes {
+    static const size_t kLanes = 4;
+    typedef __m256i Reg;
+    typedef __m256i Mask;
+
+    BATCH_AVX2 static Reg Zero() { return _mm256_setzero_si256(); }
+    BATCH_AVX2 static Reg Broadcast(uint64_t x) { return _mm256_set1_epi64x((long long)x); }
+    BATCH_AVX2 static Reg Load(const uint64_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    BATCH_AVX2 static void Store(uint64_t* p, Reg a) { _mm256_storeu_si256((__m256i*)p, a); }
+    BATCH_AVX2 static Reg Add(Reg a, Reg b) { return _mm256_add_epi64(a, b); }
+    BATCH_AVX2 static Reg And(Reg a, Reg b) { return _mm256_and_si256(a, b); }
+    BATCH_AVX2 static Reg ShiftRight(Reg a, unsigned int bits) {
+        return _mm256_srl_epi64(a, _mm_cvtsi32_si128(int(bits)));
+    }
+    BATCH_AVX2 static Reg Low52(Reg a) { return _mm256_and_si256(a, Broadcast(kMask52)); }
+    BATCH_AVX2 static Reg High52(Reg a) { return _mm256_srli_epi64(a, 52); }
+    BATCH_AVX2 static void MulAdd52(Reg& lo, Reg& hi, Reg a, Reg b) {
+        const Reg mask26 = _mm256_set1_epi64x((1LL << 26) - 1);
+        // a, b < 2^52 split into 26-bit halves, each product below 2^52
+        Reg a0 = _mm256_and_si256(a, mask26), b0 = _mm256_and_si256(b, mask26);
+        Reg a1 = _mm256_srli_epi64(a, 26), b1 = _mm256_srli_epi64(b, 26);
+        Reg p00 = _mm256_mul_epu32(a0, b0);
+        Reg mid = _mm256_add_epi64(_mm256_mul_epu32(a0, b1), _mm256_mul_epu32(a1, b0));
+        Reg p11 = _mm256_mul_epu32(a1, b1);
+        Reg low = _mm256_add_epi64(p00, _mm256_slli_epi64(_mm256_and_si256(mid, mask26), 26));
+        lo = _mm256_add_epi64(lo, Low52(low));
+        hi = _mm256_add_epi64(hi, _mm256_add_epi64(p11, _mm256_add_epi64(_mm256_srli_epi64(mid, 26),
+                                                                          _mm256_srli_epi64(low, 52))));
+    }
+    BATCH_AVX2 static Reg MulLow52(Reg a, Reg b) {
+        Reg lo = Zero(), hi = Zero();
+        MulAdd52(lo, hi, Low52(a), b);
+        return lo;
+    }
+    BATCH_AVX2 static Mask Equal(Reg a, uint64_t x) { return _mm256_cmpeq_epi64(a, Broadcast(x)); }
+    BATCH_AVX2 static Reg Blend(Reg current, Reg candidate, Mask m) {
+        return _mm256_or_si256(_mm256_and_si256(candidate, m), _mm256_andnot_si256(m, current));
+    }
+};
+
+#define BATCH_IFMA __attribute__((target("avx512f,avx512ifma")))
+
+struct IfmaLanes {
+    static const size_t kLanes = 8;
+    typedef __m512i Reg;
+    typedef __mmask8 Mask;
+
+    BATCH_IFMA static Reg Zero() { return _mm512_setzero_si512(); }
+    BATCH_IFMA static Reg Broadcast(uint64_t x) { return _mm512_set1_epi64((long long)x); }
+    BATCH_IFMA static Reg Load(const uint64_t* p) { return _mm512_loadu_si512(p); }
+    BATCH_IFMA static void Store(uint64_t* p, Reg a) { _mm512_storeu_si512(p, a); }
+    BATCH_IFMA static Reg Add(Reg a, Reg b) { return _mm512_add_epi64(a, b); }
+    BATCH_IFMA static Reg And(Reg a, Reg b) { return _mm512_and_si512(a, b); }
+    BATCH_IFMA static Reg ShiftRight(Reg a, unsigned int bits) {
+        return _mm512_srl_epi64(a, _mm_cvtsi32_si128(int(bits)));
+    }
+    BATCH_IFMA static Reg Low52(Reg a) { return _mm512_and_si512(a, Broadcast(kMask52)); }
+    BATCH_IFMA static Reg High52(Reg a) { return _mm512_srli_epi64(a, 52); }
+    BATCH_IFMA static void MulAdd52(Reg& lo, Reg& hi, Reg a, Reg b) {
+        lo = _mm512_madd52lo_epu64(lo, a, b);
+        hi = _mm512_madd52hi_epu64(hi, a, b);
+    }
+    // vpmadd52luq reads only the low 52 bits of each input
+    BATCH_IFMA static Reg MulLow52(Reg a, Reg b) { return _mm512_madd52lo_epu64(Zero(), a, b); }
+    BATCH_IFMA static Mask Equal(Reg a, uint64_t x) { return _mm512_cmpeq_epi64_mask(a, Broadcast(x)); }
+    BATCH_IFMA static Reg Blend(Reg current, Reg candidate, Mask m) {
+        return _mm512_mask_blend_epi64(m, current, candidate);
+    }
+};
+
+// Function to compute r = a * b / R mod n in every lane, for a, b < 2n and
+// R > 4n, leaving r < 2n. The product and the reduction accumulate into
+// 2 * limbs unnormalised words indexed by absolute position, so nothing
+// shifts between rounds; carries are resolved once at the end. r may
+// alias a or b.
+template <typename V>
+inline void BatchMultiply(uint64_t* r, const uint64_t* a, const uint64_t* b, const typename V::Reg* n,
+                          typename V::Reg k0, size_t limbs) {
+    typedef typename V::Reg Reg;
+    const size_t L = V::kLanes;
+    Reg acc[2 * kBatchMaxLimbs];
+    for (size_t k = 0; k < 2 * limbs; k++) {
+        acc[k] = V::Zero();
+    }
+    for (size_t i = 0; i < limbs; i++) {
+        Reg bi = V::Load(b + i * L);
+        for (size_t j = 0; j < limbs; j++) {
+            V::MulAdd52(acc[i + j], acc[i + j + 1], V::Load(a + j * L), bi);
+        }
+        // m clears the low 52 bits of word i; its overflow moves up a word
+        Reg m = V::MulLow52(acc[i], k0);
+        for (size_t j = 0; j < limbs; j++) {
+            V::MulAdd52(acc[i + j], acc[i + j + 1], n[j], m);
+        }
+        acc[i + 1] = V::Add(acc[i + 1], V::High52(acc[i]));
+    }
+    Reg carry = V::Zero();
+    for (size_t j = 0; j < limbs; j++) {
+        Reg word = V::Add(acc[limbs + j], carry);
+        V::Store(r + j * L, V::Low52(word));
+        carry = V::High52(word);
+    }
+}
+
+// Function to run the fixed-window exponentiation over one group of lanes.
+// The sequence of operations depends only on job.limbs and
+// job.exponentBits; every lane's window value is used only as a blend
+// mask while scanning the whole table.
+template <typename V>
+inline void BatchExp(const BatchExpJob& job) {
+    typedef typename V::Reg Reg;
+    const size_t L = V::kLanes;
+    const size_t limbs = job.limbs;
+    const size_t block = limbs * L;
+
+    Reg n[kBatchMaxLimbs];
+    for (size_t j = 0; j < limbs; j++) {
+        n[j] = V::Broadcast(job.modulus[j]);
+    }
+    const Reg k0 = V::Broadcast(job.k0);
+
+    // Same window widths as FixedMontgomery::Exp
+    const unsigned int windowBits = job.exponentBits <= 512 ? 4 : 5;
+    const size_t entries = size_t(1) << windowBits;
+
+    uint64_t* table = job.table;
+    BatchMultiply<V>(table, job.r2, job.one, n, k0, limbs);           // R mod n, 1 in Montgomery form
+    BatchMultiply<V>(table + block, job.bases, job.r2, n, k0, limbs); // base * R mod n
+    for (size_t e = 2; e < entries; e++) {
+        BatchMultiply<V>(table + e * block, table + (e - 1) * block, table + block, n, k0, limbs);
+    }
+
+    uint64_t* acc = job.results;
+    for (size_t k = 0; k < block; k++) {
+        acc[k] = table[k];
+    }
+    const Reg bitMask = V::Broadcast(1);
+    size_t windows = (job.exponentBits + windowBits - 1) / windowBits;
+    for (size_t w = windows; w-- > 0;) {
+        if (w + 1 != windows) {
+            for (unsigned int s = 0; s < windowBits; s++) {
+                BatchMultiply<V>(acc, acc, acc, n, k0, limbs);
+            }
+        }
+        Reg index = V::Zero();
+        for (unsigned int b = windowBits; b-- > 0;) {
+            size_t bit = w * windowBits + b;
+            Reg next = V::Add(index, index);
+            if (bit < job.exponentBits) {
+                Reg word = V::Load(job.exponents + (bit / 64) * L);
+                next = V::Add(next, V::And(V::ShiftRight(word, unsigned(bit % 64)), bitMask));
+            }
+            index = next;
+        }
+        for (size_t j = 0; j < limbs; j++) {
+            V::Store(job.selected + j * L, V::Zero());
+        }
+        for (size_t e = 0; e < entries; e++) {
+            typename V::Mask mask = V::Equal(index, e);
+            const uint64_t* entry = table + e * block;
+            for (size_t j = 0; j < limbs; j++) {
+                Reg current = V::Load(job.selected + j * L);
+                V::Store(job.selected + j * L, V::Blend(current, V::Load(entry + j * L), mask));
+            }
+        }
+        BatchMultiply<V>(acc, acc, job.selected, n, k0, limbs);
+    }
+    // Multiplying by 1 leaves a value of at most n, equal to n only for a zero base
+    BatchMultiply<V>(acc, acc, job.one, n, k0, limbs);
+}
+
+// One entry point per policy; flatten inlines the whole kernel so each
+// body is compiled for its own instruction set
+__attribute__((flatten)) static void BatchExpPortable(const BatchExpJob& job) {
+    BatchExp<PortableLanes>(job);
+}
+
+__attribute__((target("avx2"), flatten)) static void BatchExpAvx2(const BatchExpJob& job) {
+    BatchExp<Avx2Lanes>(job);
+}
+
+__attribute__((target("avx512f,avx512ifma"), flatten)) static void BatchExpIfma(const BatchExpJob& job) {
+    BatchExp<IfmaLanes>(job);
+}
+
+BatchKernel DetectBatchKernel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512ifma") && __builtin_cpu_supports("avx512f")) {
+        return BatchKernel::Avx512Ifma;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return BatchKernel::Avx2;
+    }
+    return BatchKernel::Portable;
+}
+
+const char* BatchKernelName(BatchKernel kernel) {
+    switch (kernel) {
+    case BatchKernel::Auto: return "auto";
+    case BatchKernel::Portable: return "portable";
+    case BatchKernel::Avx2: return "avx2";
+    case BatchKernel::Avx512Ifma: return "avx512ifma";
+    }
+    return "unknown";
+}
+
+BatchKernel ParseBatchKernel(const std::string& name) {
+    for (BatchKernel kernel : {BatchKernel::Auto, BatchKernel::Portable, BatchKernel::Avx2, BatchKernel::Avx512Ifma}) {
+        if (name == BatchKernelName(kernel)) {
+            return kernel;
+        }
+    }
+    throw InvalidArgument("Unknown batch kernel: " + name);
+}
+
+// Function to write limb j of a value into column `lane` of a lane-major array
+static void SpreadLimbs(const Integer& value, uint64_t* out, size_t limbs, size_t lanes, size_t lane) {
+    for (size_t j = 0; j < limbs; j++) {
+        out[j * lanes + lane] = value.GetBits(52 * j, 52);
+    }
+}
+
+// Function to read column `lane` of a lane-major array back into an Integer
+static Integer GatherLimbs(const uint64_t* in, size_t limbs, size_t lanes, size_t lane) {
+    Integer value;
+    for (size_t j = limbs; j-- > 0;) {
+        value <<= 52;
+        value += Integer(static_cast<lword>(in[j * lanes + lane]));
+    }
+    return value;
+}
+
+BatchExpContext::BatchExpContext(const Integer& modulus, BatchKernel kernel)
+    : m_modulus(modulus), m_kernel(kernel == BatchKernel::Auto ? DetectBatchKernel() : kernel) {
+    if (modulus.IsEven() || modulus < 3 || modulus.BitCount() > 4096) {
+        throw InvalidArgument("BatchExpContext: modulus must be odd and at most 4096 bits");
+    }
+    if (m_kernel == BatchKernel::Avx512Ifma && !__builtin_cpu_supports("avx512ifma")) {
+        throw InvalidArgument("BatchExpContext: this CPU has no AVX-512 IFMA");
+    }
+    if (m_kernel == BatchKernel::Avx2 && !__builtin_cpu_supports("avx2")) {
+        throw InvalidArgument("BatchExpContext: this CPU has no AVX2");
+    }
+
+    // Two spare bits keep the lazily reduced values below 2n < R / 2
+    m_limbs = (modulus.BitCount() + 2 + 51) / 52;
+    m_n.resize(m_limbs);
+    for (size_t j = 0; j < m_limbs; j++) {
+        m_n[j] = modulus.GetBits(52 * j, 52);
+    }
+
+    // -n^-1 mod 2^64 by Newton iteration, then cut to 52 bits
+    uint64_t n0 = modulus.GetBits(0, 64);
+    uint64_t inverse = 1;
+    for (int i = 0; i < 6; i++) {
+        inverse *= 2 - n0 * inverse;
+    }
+    m_k0 = (0 - inverse) & kMask52;
+
+    Integer r2 = Integer::Power2(2 * 52 * m_limbs) % modulus;
+    m_r2.resize(m_limbs);
+    for (size_t j = 0; j < m_limbs; j++) {
+        m_r2[j] = r2.GetBits(52 * j, 52);
+    }
+}
+
+size_t BatchExpContext::Lanes() const {
+    return m_kernel == BatchKernel::Avx512Ifma ? IfmaLanes::kLanes
+         : m_kernel == BatchKernel::Avx2      ? Avx2Lanes::kLanes
+                                              : PortableLanes::kLanes;
+}
+
+void BatchExpContext::Exp(const Integer* bases, const Integer* exponents, size_t count, size_t exponentBits,
+                          Integer* results) const {
+    DH_METRIC_TIME("dh_batch_exp_seconds", "Time per batched exponentiation call");
+    DH_METRIC_COUNT("dh_batch_exp_total", "Exponentiations run in vector lanes", count);
+    if (exponentBits == 0 || exponentBits > 52 * m_limbs) {
+        throw InvalidArgument("BatchExpContext: exponent length out of range");
+    }
+    const size_t lanes = Lanes();
+    const size_t block = m_limbs * lanes;
+    const size_t exponentWords = (exponentBits + 63) / 64;
+    const size_t entries = exponentBits <= 512 ? 16 : 32;
+
+    // r2 | one | bases | exponents | results | selected | table
+    m_scratch.assign(5 * block + exponentWords * lanes + entries * block, 0);
+    uint64_t* r2 = m_scratch.data();
+    uint64_t* one = r2 + block;
+    uint64_t* laneBases = one + block;
+    uint64_t* laneExponents = laneBases + block;
+    uint64_t* laneResults = laneExponents + exponentWords * lanes;
+    uint64_t* selected = laneResults + block;
+    uint64_t* table = selected + block;
+    for (size_t j = 0; j < m_limbs; j++) {
+        for (size_t l = 0; l < lanes; l++) {
+            r2[j * lanes + l] = m_r2[j];
+        }
+    }
+    for (size_t l = 0; l < lanes; l++) {
+        one[l] = 1;
+    }
+
+    BatchExpJob job;
+    job.limbs = m_limbs;
+    job.k0 = m_k0;
+    job.modulus = m_n.data();
+    job.r2 = r2;
+    job.one = one;
+    job.bases = laneBases;
+    job.exponents = laneExponents;
+    job.exponentBits = exponentBits;
+    job.results = laneResults;
+    job.table = table;
+    job.selected = selected;
+
+    for (size_t first = 0; first < count; first += lanes) {
+        size_t used = std::min(lanes, count - first);
+        for (size_t l = 0; l < lanes; l++) {
+            // Idle lanes compute 1^0
+            Integer base = l < used ? bases[first + l] % m_modulus : Integer::One();
+            Integer exponent = l < used ? exponents[first + l] : Integer::Zero();
+            if (exponent.IsNegative() || exponent.BitCount() > exponentBits) {
+                throw InvalidArgument("BatchExpContext: exponent longer than " + std::to_string(exponentBits) + " bits");
+            }
+            SpreadLimbs(base, laneBases, m_limbs, lanes, l);
+            for (size_t w = 0; w < exponentWords; w++) {
+                laneExponents[w * lanes + l] = exponent.GetBits(64 * w, 64);
+            }
+        }
+
+        switch (m_kernel) {
+        case BatchKernel::Avx512Ifma: BatchExpIfma(job); break;
+        case BatchKernel::Avx2: BatchExpAvx2(job); break;
+        default: BatchExpPortable(job); break;
+        }
+
+        for (size_t l = 0; l < used; l++) {
+            results[first + l] = GatherLimbs(laneResults, m_limbs, lanes, l) % m_modulus;
+        }
+    }
+}
+
+void BatchExpContext::Exp(const std::vector<Integer>& bases, const std::vector<Integer>& exponents,
+                          size_t exponentBits, std::vector<Integer>& results) const {
+    if (bases.size() != exponents.size()) {
+        throw InvalidArgument("BatchExpContext: bases and exponents differ in number");
+    }
+    results.resize(bases.size());
+    Exp(bases.data(), exponents.data(), bases.size(), exponentBits, results.data());
+}
@@ -0,0 +1,61 @@
+#ifndef BATCH_EXP_H
+#define BATCH_EXP_H
+
+#include "crypto_headers.h"
+
+// Instruction sets the batched exponentiation kernel is built for
+enum class BatchKernel {
+    Auto,       // the widest one this CPU supports
+    Portable,   // plain C++, 4 lanes
+    Avx2,       // 4 lanes of 64 bits, 52-bit products from 32x32 multiplies
+    Avx512Ifma, // 8 lanes of 64 bits, 52-bit multiply-accumulate
+};
+
+// Function to pick the widest kernel this CPU supports
+BatchKernel DetectBatchKernel();
+
+// Function to name a kernel for reports
+const char* BatchKernelName(BatchKernel kernel);
+
+// Function to parse a kernel name as printed by BatchKernelName
+BatchKernel ParseBatchKernel(const std::string& name);
+
+// Exponentiation of many independent (base, exponent) pairs modulo one odd
+// modulus of up to 4096 bits, one vector lane per pair. Operands are held
+// structure-of-arrays in radix 2^52, so limb j of every lane sits in one
+// vector register, and all lanes run the same Montgomery multiplications
+// in lockstep. The exponent is scanned in fixed windows whose table
+// entries are selected by scanning the whole table, so the work depends
+// only on the modulus size and the declared exponent length, as with
+// SecretExpContext. Like ModExpContext, a context keeps scratch buffers
+// and is not safe to share between threads; build one per thread.
+class BatchExpContext {
+public:
+    explicit BatchExpContext(const CryptoPP::Integer& modulus, BatchKernel kernel = BatchKernel::Auto);
+
+    // Function to compute results[i] = bases[i]^exponents[i] mod modulus for
+    // i < count, with every exponent below 2^exponentBits; a partial final
+    // group of lanes is padded internally
+    void Exp(const CryptoPP::Integer* bases, const CryptoPP::Integer* exponents, size_t count, size_t exponentBits,
+             CryptoPP::Integer* results) const;
+
+    // Function to compute the same for vectors of pairs
+    void Exp(const std::vector<CryptoPP::Integer>& bases, const std::vector<CryptoPP::Integer>& exponents,
+             size_t exponentBits, std::vector<CryptoPP::Integer>& results) const;
+
+    size_t Lanes() const;
+    BatchKernel Kernel() const { return m_kernel; }
+    bool IsVectorized() const { return m_kernel != BatchKernel::Portable; }
+    const CryptoPP::Integer& GetModulus() const { return m_modulus; }
+
+private:
+    CryptoPP::Integer m_modulus;
+    BatchKernel m_kernel;
+    size_t m_limbs;                  // radix-2^52 limbs, with R = 2^(52 * m_limbs) > 4 * modulus
+    uint64_t m_k0;                   // -modulus^-1 mod 2^52
+    std::vector<uint64_t> m_n;       // modulus limbs
+    std::vector<uint64_t> m_r2;      // R^2 mod modulus
+    mutable std::vector<uint64_t> m_scratch;
+};
+
+#endif // BATCH_EXP_H
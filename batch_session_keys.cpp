@@ -0,0 +1,124 @@
+#include "session_key_engine.h"
+#include "session_kdf.h"
+#include "certificate.h"
+#include "key_store.h"
+
+using namespace CryptoPP;
+
+// Function to time one batch in seconds
+double TimeBatch(SessionKeyEngine& engine, const std::vector<SessionKeyJob>& jobs, std::vector<SessionKeyResult>& results) {
+    auto start = std::chrono::steady_clock::now();
+    engine.Derive(jobs, results);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 5) {
+        std::cerr << "Usage: " << argv[0] << " <manifest_file> [max_threads] [repeat] [kernel]" << std::endl;
+        std::cerr << "Each manifest line: <certificate_file> <private_key_file> <output_file>" << std::endl;
+        std::cerr << "Kernels: auto, portable (scalar engine only), avx2, avx512ifma" << std::endl;
+        return 1;
+    }
+
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 2) {
+        // At least one thread, or no pass would run and there would be no results
+        maxThreads = unsigned(std::max<unsigned long>(1, std::stoul(argv[2])));
+    }
+    size_t repeat = argc > 3 ? std::stoul(argv[3]) : 1;
+
+    try {
+        BatchKernel kernel = argc > 4 ? ParseBatchKernel(argv[4]) : BatchKernel::Auto;
+        Integer p, q, g;
+        LoadIntegersFromFile("params.bin", p, q, g);
+
+        // Read the whole queue up front so the timed section is pure derivation
+        std::ifstream manifest(argv[1]);
+        if (!manifest) {
+            throw std::runtime_error("Unable to open file: " + std::string(argv[1]));
+        }
+        std::vector<SessionKeyJob> jobs;
+        std::vector<std::string> outputFiles;
+        std::string certFile, privateKeyFile, outputFile;
+        while (manifest >> certFile >> privateKeyFile >> outputFile) {
+            SessionKeyJob job;
+            job.certificate = ReadFile(certFile);
+            LoadIntegerFromFile(privateKeyFile, job.privateKey);
+            jobs.push_back(job);
+            outputFiles.push_back(outputFile);
+        }
+        if (jobs.empty()) {
+            throw std::runtime_error("Manifest lists no jobs");
+        }
+
+        // Replicate the queue so small manifests still give stable timings
+        size_t uniqueJobs = jobs.size();
+        for (size_t r = 1; r < repeat; r++) {
+            jobs.insert(jobs.end(), jobs.begin(), jobs.begin() + uniqueJobs);
+        }
+
+        std::vector<SessionKeyResult> results, baseline;
+        double singleThread = 0;
+        for (unsigned int threads = 1; threads <= maxThreads; threads++) {
+            // Private keys are below q, so q sets the exponent length
+            SessionKeyEngine engine(p, threads, q.BitCount(), kernel);
+            if (threads == 1) {
+                std::cout << "kernel: " << (engine.Kernel() == BatchKernel::Portable ? "scalar" : BatchKernelName(engine.Kernel()))
+                          << std::endl;
+                std::cout << "threads   seconds     keys/s   speedup" << std::endl;
+            }
+            double seconds = TimeBatch(engine, jobs, results);
+            if (threads == 1) {
+                singleThread = seconds;
+                baseline = results;
+            }
+            for (size_t i = 0; i < results.size(); i++) {
+                if (results[i].sessionKey != baseline[i].sessionKey) {
+                    throw std::runtime_error("Session keys differ between thread counts");
+                }
+            }
+            std::cout << std::setw(7) << threads << std::setw(10) << std::fixed << std::setprecision(3) << seconds
+                      << std::setw(11) << std::setprecision(1) << jobs.size() / seconds
+                      << std::setw(9) << std::setprecision(2) << singleThread / seconds << "x" << std::endl;
+        }
+
+        // Expand every secret into the same fixed-length key sessionKeyGen
+        // writes, in one pass over a packed buffer of p-length secrets
+        SessionKdf kdf({{kDefaultKdfLabel, kDefaultKdfLength}});
+        size_t secretLength = p.ByteCount();
+        // Zero-filled so the slots of failed jobs hash defined bytes
+        SecByteBlock secrets, keys(uniqueJobs * kdf.OutputLength());
+        secrets.CleanNew(uniqueJobs * secretLength);
+        for (size_t i = 0; i < uniqueJobs; i++) {
+            if (results[i].error.empty()) {
+                results[i].sessionKey.Encode(secrets + i * secretLength, secretLength);
+            }
+        }
+        auto kdfStart = std::chrono::steady_clock::now();
+        kdf.DeriveBatch(secrets, secretLength, uniqueJobs, keys);
+        auto kdfEnd = std::chrono::steady_clock::now();
+        std::cout << "kdf: " << uniqueJobs << " keys in " << std::setprecision(3)
+                  << std::chrono::duration<double, std::milli>(kdfEnd - kdfStart).count() << " ms" << std::endl;
+
+        int failures = 0;
+        for (size_t i = 0; i < uniqueJobs; i++) {
+            if (!results[i].error.empty()) {
+                std::cerr << "Job " << i + 1 << " failed: " << results[i].error << std::endl;
+                failures++;
+                continue;
+            }
+            WriteFileBytes(outputFiles[i], std::string(reinterpret_cast<const char*>(keys + i * kdf.OutputLength()),
+                                                       kdf.OutputLength()));
+        }
+        std::cout << "Derived " << uniqueJobs - failures << " of " << uniqueJobs << " session keys" << std::endl;
+        return failures == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+// g++ -O2 -o test batch_session_keys.cpp session_key_engine.cpp session_kdf.cpp batch_exp.cpp certificate.cpp certificate_stream.cpp key_store.cpp dh_container.cpp secret_exp.cpp mod_exp.cpp metrics.cpp -lcryptopp -lpthread
+// ./test jobs.txt 8 100
+// ./test jobs.txt 8 100 portable
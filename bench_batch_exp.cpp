@@ -0,0 +1,101 @@
+#include "batch_exp.h"
+#include "secret_exp.h"
+
+using namespace CryptoPP;
+
+// Function to time a whole batch in microseconds per exponentiation
+template <typename F>
+double TimePerExp(F&& f, size_t count) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / count;
+}
+
+// Function to compare the scalar engines with every batched kernel this
+// CPU can run, on the same bases and exponents
+void BenchmarkModulusSize(RandomNumberGenerator& rng, size_t modulusBits, size_t exponentBits, size_t count,
+                          const std::vector<BatchKernel>& kernels) {
+    Integer modulus;
+    modulus.Randomize(rng, modulusBits);
+    modulus.SetBit(modulusBits - 1);
+    modulus.SetBit(0);
+
+    std::vector<Integer> bases(count), exponents(count), expected(count), results;
+    for (size_t i = 0; i < count; i++) {
+        bases[i].Randomize(rng, 2, modulus - 1);
+        exponents[i].Randomize(rng, exponentBits);
+    }
+
+    ModExpContext ctx(modulus);
+    SecretExpContext secret(modulus);
+    double sliding = TimePerExp([&] {
+        for (size_t i = 0; i < count; i++) expected[i] = ctx.Exp(bases[i], exponents[i]);
+    }, count);
+    Integer sink;
+    double fixed = TimePerExp([&] {
+        for (size_t i = 0; i < count; i++) sink += secret.Exp(bases[i], exponents[i], exponentBits);
+    }, count);
+
+    std::cout << std::setw(6) << modulusBits << std::setw(6) << exponentBits << std::setw(11) << std::fixed
+              << std::setprecision(1) << sliding << std::setw(10) << fixed;
+    for (BatchKernel kernel : kernels) {
+        BatchExpContext batch(modulus, kernel);
+        double batched = TimePerExp([&] { batch.Exp(bases, exponents, exponentBits, results); }, count);
+        // Every lane must agree with the scalar engine before the time counts
+        if (results != expected) {
+            throw std::runtime_error(std::string("Batched kernel ") + BatchKernelName(kernel) +
+                                     " disagrees with ModExpContext");
+        }
+        std::cout << std::setw(10) << batched << " (" << std::setprecision(2) << fixed / batched << "x)"
+                  << std::setprecision(1);
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = 64;
+    if (argc > 2) {
+        std::cerr << "Usage: " << argv[0] << " [exponentiations]" << std::endl;
+        return 1;
+    }
+    if (argc == 2) {
+        count = std::stoul(argv[1]);
+    }
+
+    // The portable kernel always runs; vector kernels only where supported
+    std::vector<BatchKernel> kernels = {BatchKernel::Portable};
+    BatchKernel best = DetectBatchKernel();
+    if (best == BatchKernel::Avx2 || best == BatchKernel::Avx512Ifma) {
+        kernels.push_back(BatchKernel::Avx2);
+    }
+    if (best == BatchKernel::Avx512Ifma) {
+        kernels.push_back(BatchKernel::Avx512Ifma);
+    }
+
+    AutoSeededRandomPool rng;
+    const size_t modulusSizes[] = {1024, 2048, 3072, 4096};
+
+    // Times are microseconds per exponentiation; the factor is the speedup
+    // over the scalar constant-time engine
+    std::cout << "   |p|   |e|  window us  fixed us";
+    for (BatchKernel kernel : kernels) {
+        std::cout << std::setw(18) << BatchKernelName(kernel);
+    }
+    std::cout << std::endl;
+    try {
+        for (size_t bits : modulusSizes) {
+            // A handshake exponent below q, and a full-length exponent
+            BenchmarkModulusSize(rng, bits, 256, count, kernels);
+            BenchmarkModulusSize(rng, bits, bits, count, kernels);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test bench_batch_exp.cpp batch_exp.cpp secret_exp.cpp mod_exp.cpp metrics.cpp -lcryptopp
+// ./test 64
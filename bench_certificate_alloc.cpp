@@ -0,0 +1,160 @@
+#include "certificate.h"
+#include "certificate_stream.h"
+#include "certificate_signer.h"
+
+using namespace CryptoPP;
+
+// Every heap allocation in the process is counted by interposing the
+// malloc family. This covers operator new, which calls malloc, and the
+// Integer and SecBlock storage Crypto++ allocates with malloc or
+// posix_memalign. The glibc entry points do the real work.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* block, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* block);
+}
+
+static std::atomic<unsigned long long> g_allocations(0);
+static std::atomic<unsigned long long> g_allocatedBytes(0);
+
+static void CountAllocation(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+extern "C" {
+void* malloc(size_t size) noexcept {
+    CountAllocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    CountAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* block, size_t size) noexcept {
+    CountAllocation(size);
+    return __libc_realloc(block, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+    CountAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** block, size_t alignment, size_t size) noexcept {
+    void* result = memalign(alignment, size);
+    if (!result) {
+        return ENOMEM;
+    }
+    *block = result;
+    return 0;
+}
+
+void free(void* block) noexcept {
+    __libc_free(block);
+}
+}
+
+// Function to count the allocations and time of `iterations` calls
+template <typename F>
+void Measure(const std::string& name, F&& f, size_t iterations) {
+    f(); // Warm up lazily built state outside the count
+    unsigned long long allocations = g_allocations, bytes = g_allocatedBytes;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        f();
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << double(g_allocations - allocations) / iterations << std::setw(12)
+              << double(g_allocatedBytes - bytes) / iterations << std::setw(11)
+              << std::chrono::duration<double, std::micro>(end - start).count() / iterations << std::endl;
+}
+
+// Function to issue a certificate the way Generate_Certificate used to:
+// certificate text, then a hash string, then a signature string, then a
+// Base64 string, then the concatenation
+std::string LegacyIssue(const Integer& publicKey, const DSA::Signer& signer, RandomNumberGenerator& rng) {
+    std::string hash = HashCertificateData(CertificateData(publicKey));
+    std::string signature(signer.MaxSignatureLength(), 0);
+    signature.resize(signer.SignMessage(rng, reinterpret_cast<const byte*>(hash.data()), hash.size(),
+                                        reinterpret_cast<byte*>(&signature[0])));
+    return FormatCertificate(publicKey, signature);
+}
+
+// Function to verify a certificate the way Ver_Cer used to: split out the
+// data and Base64 text, decode, hash the data copy, then verify
+bool LegacyVerify(const std::string& certificate, const DSA::Verifier& verifier) {
+    std::string certData, encoded, signature;
+    ExtractDataAndSignature(certificate, certData, encoded);
+    StringSource ss(encoded, true, new Base64Decoder(new StringSink(signature)));
+    std::string hash = HashCertificateData(certData);
+    return verifier.VerifyMessage(reinterpret_cast<const byte*>(hash.data()), hash.size(),
+                                  reinterpret_cast<const byte*>(signature.data()), signature.size());
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [iterations] [key_bits]" << std::endl;
+        return 1;
+    }
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 1000;
+    unsigned int bits = argc > 2 ? std::stoul(argv[2]) : 2048;
+
+    try {
+        DSA::PrivateKey caPrivateKey;
+        LoadDSAPrivateKey("CA_Priv.bin", caPrivateKey);
+        DSA::PublicKey caPublicKey;
+        caPrivateKey.MakePublicKey(caPublicKey);
+        DSA::Signer signer(caPrivateKey);
+        DSA::Verifier verifier(caPublicKey);
+        AutoSeededRandomPool rng;
+
+        Integer publicKey;
+        publicKey.Randomize(rng, Integer::Power2(bits - 1), Integer::Power2(bits) - 1);
+        std::string certificate = IssueCertificate(publicKey, signer, rng);
+        if (LegacyIssue(publicKey, signer, rng).size() != certificate.size() ||
+            !LegacyVerify(certificate, verifier) || !VerifyCertificateSignature(certificate, verifier)) {
+            throw std::runtime_error("Streaming and legacy certificates disagree");
+        }
+
+        // The engine signs without DSA::Signer's per-message accumulator
+        NoncePoolConfig noPool;
+        noPool.depth = 0;
+        SigningEngine engine(caPrivateKey, noPool);
+        ModExpContext ctx(engine.GetModulus());
+        CertificateArena arena;
+
+        std::cout << bits << "-bit public key, " << iterations << " iterations" << std::endl;
+        std::cout << "path                              allocs/op    bytes/op      us/op" << std::endl;
+        Measure("issue, legacy strings", [&] { LegacyIssue(publicKey, signer, rng); }, iterations);
+        Measure("issue, streaming", [&] { IssueCertificate(publicKey, signer, rng); }, iterations);
+        Measure("issue, streaming + engine", [&] { engine.Issue(publicKey, false, ctx, rng); }, iterations);
+        Measure("issue, engine into reused arena", [&] {
+            arena.Reset();
+            CertificateStreamWriter writer(arena, false);
+            byte hash[SHA256::DIGESTSIZE];
+            writer.WriteSignedPart(publicKey, engine.SignatureLength(), hash);
+            size_t length = engine.SignDigest(hash, sizeof(hash), writer.SignatureBuffer(), ctx, rng);
+            writer.WriteSignature(writer.SignatureBuffer(), length);
+        }, iterations);
+        Measure("verify, legacy strings", [&] { LegacyVerify(certificate, verifier); }, iterations);
+        Measure("verify, streaming", [&] { VerifyCertificateSignature(certificate, verifier); }, iterations);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test bench_certificate_alloc.cpp certificate.cpp certificate_stream.cpp certificate_signer.cpp fixed_base.cpp mod_exp.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp -lpthread
+// ./test 1000 2048
@@ -0,0 +1,76 @@
+#include "certificate.h"
+
+using namespace CryptoPP;
+
+// Function to time one parser in microseconds per call
+template <typename F>
+double TimePerCall(F&& f, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        f();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 2) {
+        std::cerr << "Usage: " << argv[0] << " [iterations]" << std::endl;
+        return 1;
+    }
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 2000;
+
+    try {
+        AutoSeededRandomPool rng;
+        std::cout << "bits   text bytes  binary bytes  text us  view us  view+decode us  speedup" << std::endl;
+
+        for (unsigned int bits : {2048u, 4096u}) {
+            // A full-width public key and a DSA-sized signature; parsing does
+            // not look at whether the signature is valid
+            Integer publicKey;
+            publicKey.Randomize(rng, Integer::Power2(bits - 1), Integer::Power2(bits) - 1);
+            std::string signature(40, 0);
+            rng.GenerateBlock(reinterpret_cast<byte*>(&signature[0]), signature.size());
+
+            std::string text = FormatCertificate(publicKey, signature);
+            std::string binary = BinaryCertificateData(publicKey);
+            binary.push_back(char(signature.size() >> 8));
+            binary.push_back(char(signature.size()));
+            binary.append(signature);
+
+            // Both formats must yield the same key and signature
+            Integer textKey, binaryKey;
+            std::string textSignature;
+            ParseCertificate(text, textKey, textSignature);
+            CertificateView view;
+            ParseBinaryCertificate(reinterpret_cast<const byte*>(binary.data()), binary.size(), view);
+            binaryKey.Decode(view.publicKey, view.publicKeySize);
+            if (textKey != publicKey || binaryKey != publicKey || textSignature != signature ||
+                std::string(reinterpret_cast<const char*>(view.signature), view.signatureSize) != signature) {
+                throw std::runtime_error("Certificate parsers disagree");
+            }
+
+            double textTime = TimePerCall([&] { ParseCertificate(text, textKey, textSignature); }, iterations);
+            double viewTime = TimePerCall([&] {
+                ParseBinaryCertificate(reinterpret_cast<const byte*>(binary.data()), binary.size(), view);
+            }, iterations);
+            double decodeTime = TimePerCall([&] {
+                ParseBinaryCertificate(reinterpret_cast<const byte*>(binary.data()), binary.size(), view);
+                binaryKey.Decode(view.publicKey, view.publicKeySize);
+            }, iterations);
+
+            std::cout << std::setw(4) << bits << std::setw(13) << text.size() << std::setw(14) << binary.size()
+                      << std::fixed << std::setprecision(3) << std::setw(9) << textTime << std::setw(9) << viewTime
+                      << std::setw(16) << decodeTime << std::setprecision(1) << std::setw(8) << textTime / decodeTime
+                      << "x" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test bench_certificate_parse.cpp certificate.cpp certificate_stream.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp
+// ./test 2000
@@ -0,0 +1,75 @@
+#include "fixed_base.h"
+
+using namespace CryptoPP;
+
+// Function to time one exponentiation routine in microseconds per call
+template <typename F>
+double TimePerCall(F&& f, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        f(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " [modulus_bits] [exponent_bits] [iterations]" << std::endl;
+        return 1;
+    }
+    size_t modulusBits = argc > 1 ? std::stoul(argv[1]) : 2048;
+    size_t exponentBits = argc > 2 ? std::stoul(argv[2]) : 256;
+    size_t iterations = argc > 3 ? std::stoul(argv[3]) : 50;
+
+    AutoSeededRandomPool rng;
+    Integer modulus, base;
+    modulus.Randomize(rng, modulusBits);
+    modulus.SetBit(modulusBits - 1);
+    modulus.SetBit(0);
+    base.Randomize(rng, 2, modulus - 1);
+
+    std::vector<Integer> exponents(iterations);
+    for (Integer& e : exponents) {
+        e.Randomize(rng, exponentBits);
+    }
+
+    try {
+        ModExpContext ctx(modulus);
+        Integer sink;
+        double general = TimePerCall([&](size_t i) { sink += ctx.Exp(base, exponents[i]); }, iterations);
+
+        std::cout << "|p| = " << modulusBits << ", |x| = " << exponentBits
+                  << ", sliding-window ModExp: " << std::fixed << std::setprecision(1) << general << " us/op" << std::endl;
+        std::cout << " teeth   entries    table KiB   build ms      us/op   speedup" << std::endl;
+
+        for (unsigned int teeth = 1; teeth <= 12; teeth++) {
+            FixedBaseTable table;
+            auto start = std::chrono::steady_clock::now();
+            table.Build(base, modulus, exponentBits, teeth);
+            auto end = std::chrono::steady_clock::now();
+            double buildMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+            for (size_t i = 0; i < std::min<size_t>(iterations, 4); i++) {
+                if (table.Exp(exponents[i]) != ctx.Exp(base, exponents[i])) {
+                    throw std::runtime_error("Fixed-base table disagrees with ModExp");
+                }
+            }
+
+            double fixed = TimePerCall([&](size_t i) { sink += table.Exp(exponents[i]); }, iterations);
+            std::cout << std::setw(6) << teeth << std::setw(10) << table.Entries()
+                      << std::setw(13) << std::setprecision(1) << table.TableBytes() / 1024.0
+                      << std::setw(11) << std::setprecision(2) << buildMs
+                      << std::setw(11) << std::setprecision(1) << fixed
+                      << std::setw(9) << std::setprecision(2) << general / fixed << "x" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test bench_fixed_base.cpp fixed_base.cpp key_store.cpp dh_container.cpp mod_exp.cpp metrics.cpp -lcryptopp
+// ./test 2048 256 50
@@ -0,0 +1,88 @@
+#include "secret_exp.h"
+
+using namespace CryptoPP;
+
+// Function to time one exponentiation routine in microseconds per call
+template <typename F>
+double TimePerCall(F&& f, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        f(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+// Function to compare the sliding-window engine with the fixed-width
+// constant-time engine, and to time the constant-time engine on exponents
+// of minimum and maximum Hamming weight, which should cost the same
+void BenchmarkModulusSize(RandomNumberGenerator& rng, size_t modulusBits, size_t exponentBits, size_t iterations) {
+    Integer modulus;
+    modulus.Randomize(rng, modulusBits);
+    modulus.SetBit(modulusBits - 1);
+    modulus.SetBit(0);
+
+    std::vector<Integer> bases(iterations), exponents(iterations);
+    for (size_t i = 0; i < iterations; i++) {
+        bases[i].Randomize(rng, 2, modulus - 1);
+        exponents[i].Randomize(rng, exponentBits);
+    }
+    Integer sparse = Integer::One();
+    Integer dense = Integer::Power2(exponentBits) - 1;
+
+    // Both engines must agree before any timing is reported
+    ModExpContext ctx(modulus);
+    SecretExpContext secret(modulus);
+    for (size_t i = 0; i < std::min<size_t>(iterations, 4); i++) {
+        if (secret.Exp(bases[i], exponents[i], exponentBits) != ctx.Exp(bases[i], exponents[i]) ||
+            secret.Exp(bases[i], dense, exponentBits) != ctx.Exp(bases[i], dense)) {
+            throw std::runtime_error("Fixed-width engine disagrees with ModExpContext");
+        }
+    }
+
+    Integer sink;
+    double sliding = TimePerCall([&](size_t i) { sink += ctx.Exp(bases[i], exponents[i]); }, iterations);
+    double fixed = TimePerCall([&](size_t i) { sink += secret.Exp(bases[i], exponents[i], exponentBits); }, iterations);
+    double fixedSparse = TimePerCall([&](size_t i) { sink += secret.Exp(bases[i], sparse, exponentBits); }, iterations);
+    double fixedDense = TimePerCall([&](size_t i) { sink += secret.Exp(bases[i], dense, exponentBits); }, iterations);
+    double slidingSparse = TimePerCall([&](size_t i) { sink += ctx.Exp(bases[i], sparse); }, iterations);
+    double slidingDense = TimePerCall([&](size_t i) { sink += ctx.Exp(bases[i], dense); }, iterations);
+
+    std::cout << std::setw(6) << modulusBits << std::setw(6) << exponentBits << std::setw(7) << secret.Limbs()
+              << std::setw(12) << std::fixed << std::setprecision(1) << sliding << std::setw(12) << fixed
+              << std::setw(9) << std::setprecision(2) << sliding / fixed << "x" << std::setw(10)
+              << slidingSparse / slidingDense << std::setw(10) << fixedSparse / fixedDense << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = 20;
+    if (argc > 2) {
+        std::cerr << "Usage: " << argv[0] << " [iterations]" << std::endl;
+        return 1;
+    }
+    if (argc == 2) {
+        iterations = std::stoul(argv[1]);
+    }
+
+    AutoSeededRandomPool rng;
+    const size_t modulusSizes[] = {1024, 2048, 3072, 4096};
+
+    // The last two columns divide the time for exponent 1 by the time for
+    // an all-ones exponent of the same length; 1.00 means no timing leak
+    std::cout << "   |p|   |e| limbs  window us  fixed us  speedup  sw 1/ones  ct 1/ones" << std::endl;
+    try {
+        for (size_t bits : modulusSizes) {
+            // A handshake exponent below q, and a full-length exponent
+            BenchmarkModulusSize(rng, bits, 256, iterations);
+            BenchmarkModulusSize(rng, bits, bits, iterations);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test bench_fixed_bignum.cpp secret_exp.cpp mod_exp.cpp metrics.cpp -lcryptopp
+// ./test 20
@@ -0,0 +1,89 @@
+#include "key_agreement.h"
+#include "key_store.h"
+
+using namespace CryptoPP;
+
+// Function to time `iterations` calls and return operations per second
+template <typename F>
+double OpsPerSecond(F&& f, size_t iterations) {
+    f(); // Warm up lazily built state outside the timing
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        f();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return iterations / std::chrono::duration<double>(end - start).count();
+}
+
+// Function to return the milliseconds elapsed since `start`
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Function to benchmark one backend: key pairs/s and shared secrets/s,
+// after checking that two parties arrive at the same secret
+void BenchmarkBackend(const std::string& label, const KeyAgreementBackend& group, double setupMs, size_t iterations,
+                      RandomNumberGenerator& rng) {
+    SecByteBlock privateA(group.PrivateKeyLength()), publicA(group.PublicKeyLength());
+    SecByteBlock privateB(group.PrivateKeyLength()), publicB(group.PublicKeyLength());
+    SecByteBlock agreedA(group.AgreedValueLength()), agreedB(group.AgreedValueLength());
+    group.GenerateKeyPair(rng, privateA, publicA);
+    group.GenerateKeyPair(rng, privateB, publicB);
+    if (!group.Agree(agreedA, privateA, publicB) || !group.Agree(agreedB, privateB, publicA) || agreedA != agreedB) {
+        throw std::runtime_error(label + ": the two parties derived different secrets");
+    }
+
+    double keygen = OpsPerSecond([&] { group.GenerateKeyPair(rng, privateA, publicA); }, iterations);
+    double agree = OpsPerSecond([&] { group.Agree(agreedA, privateB, publicA); }, iterations);
+    std::cout << std::left << std::setw(18) << label << std::right << std::setw(6) << group.PrivateKeyLength()
+              << std::setw(6) << group.PublicKeyLength() << std::setw(8) << group.AgreedValueLength() << std::fixed
+              << std::setprecision(2) << std::setw(10) << setupMs << std::setprecision(0) << std::setw(13) << keygen
+              << std::setw(13) << agree << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " [iterations] [params_file] [teeth]" << std::endl;
+        return 1;
+    }
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 200;
+    std::string paramsFile = argc > 2 ? argv[2] : "params.bin";
+    unsigned int teeth = argc > 3 ? std::stoul(argv[3]) : 8;
+
+    try {
+        AutoSeededRandomPool rng;
+        Integer p, q, g;
+        LoadIntegersFromFile(paramsFile, p, q, g);
+        std::cout << "modp group: " << p.BitCount() << "-bit p, " << q.BitCount() << "-bit q; " << iterations
+                  << " iterations" << std::endl;
+        std::cout << "group              priv   pub  agreed  setup ms     keygen/s      agree/s" << std::endl;
+
+        BenchmarkBackend("modp", ModpBackend(p, q, g), 0, iterations, rng);
+        if (teeth > 0) {
+            // Fixed-base keygen; agreement still has a variable base
+            auto start = std::chrono::steady_clock::now();
+            FixedBaseTable table;
+            table.Build(g, p, q.BitCount(), teeth);
+            double setupMs = MillisecondsSince(start);
+            BenchmarkBackend("modp, comb " + std::to_string(teeth), ModpBackend(p, q, g, &table), setupMs, iterations,
+                             rng);
+        }
+        // Setup covers decoding a named group and building its shared comb table
+        for (const std::string& name : KeyAgreementBackendNames()) {
+            if (name != "modp") {
+                auto start = std::chrono::steady_clock::now();
+                std::unique_ptr<KeyAgreementBackend> group = MakeKeyAgreementBackend(name);
+                double setupMs = MillisecondsSince(start);
+                BenchmarkBackend(name, *group, setupMs, iterations, rng);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test bench_key_agreement.cpp key_agreement.cpp named_groups.cpp fixed_base.cpp secret_exp.cpp mod_exp.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp -lpthread
+// ./test 200 params.bin 8
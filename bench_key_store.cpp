@@ -0,0 +1,64 @@
+#include "key_store.h"
+
+using namespace CryptoPP;
+
+// Function to load integers the way every tool used to: an ifstream and
+// a temporary string per field
+void LegacyLoadIntegersFromFile(const std::string& filename, Integer& p, Integer& q, Integer& g) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open file: " + filename);
+    }
+
+    Integer* fields[3] = {&p, &q, &g};
+    for (Integer* field : fields) {
+        size_t size;
+        file.read(reinterpret_cast<char*>(&size), sizeof(size_t));
+        std::string str(size, 0);
+        file.read(&str[0], size);
+        field->Decode(reinterpret_cast<const byte*>(str.data()), size);
+    }
+}
+
+// Function to time one loader in microseconds per call
+template <typename F>
+double TimePerCall(F&& f, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        f();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [params_file] [iterations]" << std::endl;
+        return 1;
+    }
+    std::string paramsFile = argc > 1 ? argv[1] : "params.bin";
+    size_t iterations = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+    try {
+        Integer p, q, g, p2, q2, g2;
+        LegacyLoadIntegersFromFile(paramsFile, p, q, g);
+        LoadIntegersFromFile(paramsFile, p2, q2, g2);
+        if (p != p2 || q != q2 || g != g2) {
+            throw std::runtime_error("Loaders disagree on " + paramsFile);
+        }
+
+        double legacy = TimePerCall([&] { LegacyLoadIntegersFromFile(paramsFile, p, q, g); }, iterations);
+        double mapped = TimePerCall([&] { LoadIntegersFromFile(paramsFile, p, q, g); }, iterations);
+
+        std::cout << "ifstream loader: " << std::fixed << std::setprecision(2) << legacy << " us/load" << std::endl;
+        std::cout << "mapped loader:   " << mapped << " us/load (" << legacy / mapped << "x)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test bench_key_store.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp
+// ./test params.bin 10000
@@ -0,0 +1,80 @@
+#include "mod_exp.h"
+
+using namespace CryptoPP;
+
+// Function to time one exponentiation routine in microseconds per call
+template <typename F>
+double TimePerCall(F&& f, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        f(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+// Function to compare the square-and-multiply loop with the Montgomery engine
+void BenchmarkModulusSize(RandomNumberGenerator& rng, size_t modulusBits, size_t exponentBits, size_t iterations) {
+    Integer modulus;
+    modulus.Randomize(rng, modulusBits);
+    modulus.SetBit(modulusBits - 1);
+    modulus.SetBit(0);
+
+    std::vector<Integer> bases(iterations), exponents(iterations);
+    for (size_t i = 0; i < iterations; i++) {
+        bases[i].Randomize(rng, 2, modulus - 1);
+        exponents[i].Randomize(rng, exponentBits);
+        exponents[i].SetBit(exponentBits - 1);
+    }
+
+    // Both paths must agree before any timing is reported
+    ModExpContext ctx(modulus);
+    for (size_t i = 0; i < std::min<size_t>(iterations, 4); i++) {
+        if (ctx.Exp(bases[i], exponents[i]) != ModExpSquareMultiply(bases[i], exponents[i], modulus)) {
+            throw std::runtime_error("Montgomery engine disagrees with reference ModExp");
+        }
+    }
+
+    Integer sink;
+    double legacy = TimePerCall([&](size_t i) { sink += ModExpSquareMultiply(bases[i], exponents[i], modulus); }, iterations);
+    double oneOff = TimePerCall([&](size_t i) { sink += ModExp(bases[i], exponents[i], modulus); }, iterations);
+    double reused = TimePerCall([&](size_t i) { sink += ctx.Exp(bases[i], exponents[i]); }, iterations);
+
+    std::cout << std::setw(6) << modulusBits << std::setw(6) << exponentBits
+              << std::setw(14) << std::fixed << std::setprecision(1) << legacy
+              << std::setw(14) << oneOff
+              << std::setw(14) << reused
+              << std::setw(10) << std::setprecision(2) << legacy / reused << "x" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = 20;
+    if (argc > 2) {
+        std::cerr << "Usage: " << argv[0] << " [iterations]" << std::endl;
+        return 1;
+    }
+    if (argc == 2) {
+        iterations = std::stoul(argv[1]);
+    }
+
+    AutoSeededRandomPool rng;
+    const size_t modulusSizes[] = {1024, 2048, 3072, 4096};
+
+    std::cout << "   |p|   |e|  legacy us/op  one-off us/op  reused us/op   speedup" << std::endl;
+    try {
+        for (size_t bits : modulusSizes) {
+            // A handshake exponentiates with a private key below q, and
+            // Miller-Rabin with a full-length exponent; time both shapes
+            BenchmarkModulusSize(rng, bits, 256, iterations);
+            BenchmarkModulusSize(rng, bits, bits, iterations);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test bench_modexp.cpp mod_exp.cpp metrics.cpp -lcryptopp
+// ./test 20
@@ -0,0 +1,136 @@
+#include "prime_search.h"
+
+using namespace CryptoPP;
+
+// Function to perform Miller-Rabin the way generate_params.cpp used to:
+// a general ModExp for every squaring and an Integer loop counter
+bool LegacyIsProbablePrime(const Integer& n, RandomNumberGenerator& rng, unsigned int rounds) {
+    if (n < 2) return false;
+    if (n == 2 || n == 3) return true;
+    if (n % 2 == 0) return false;
+
+    Integer d = n - 1;
+    Integer s = 0;
+    while (d % 2 == 0) {
+        d >>= 1;
+        s += 1;
+    }
+
+    for (unsigned int i = 0; i < rounds; i++) {
+        Integer a;
+        a.Randomize(rng, 1, n - 1);
+
+        Integer x = ModExp(a, d, n);
+        if (x == 1 || x == n - 1) continue;
+
+        bool continueLoop = false;
+        for (Integer r = 0; r < s; r++) {
+            x = ModExp(x, Integer(2), n);
+            if (x == n - 1) {
+                continueLoop = true;
+                break;
+            }
+        }
+
+        if (!continueLoop) return false;
+    }
+
+    return true;
+}
+
+// One named set of numbers with the verdict every test must reach
+struct CorpusSet {
+    std::string name;
+    std::vector<Integer> numbers;
+    bool prime;
+};
+
+// Function to build the fixed corpus from a seed, so every machine times the same numbers
+std::vector<CorpusSet> BuildCorpus(unsigned long long seed) {
+    PrimeSearchOptions options;
+    options.deterministic = true;
+    std::vector<CorpusSet> corpus;
+
+    const size_t sizes[] = {512, 1024, 2048};
+    for (size_t bits : sizes) {
+        CorpusSet primes = {"prime " + std::to_string(bits), {}, true};
+        CorpusSet semiprimes = {"p*q " + std::to_string(bits), {}, false};
+        for (unsigned long long i = 0; i < 4; i++) {
+            options.seed = seed + 100 * bits + i;
+            primes.numbers.push_back(GeneratePrime(bits, options));
+            Integer a = GeneratePrime(bits / 2, options);
+            options.seed += 50;
+            semiprimes.numbers.push_back(a * GeneratePrime(bits / 2, options));
+        }
+        corpus.push_back(primes);
+        corpus.push_back(semiprimes);
+    }
+
+    // Strong pseudoprimes to base 2 and Carmichael numbers fool weak tests
+    CorpusSet tricky = {"pseudoprimes", {}, false};
+    const char* pseudoprimes[] = {"2047", "3277", "4033", "4681", "8321", "561", "41041", "825265",
+                                  "321197185", "3825123056546413051", "318665857834031151167461"};
+    for (const char* n : pseudoprimes) {
+        tricky.numbers.push_back(Integer(n));
+    }
+    corpus.push_back(tricky);
+    return corpus;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [repetitions] [seed]" << std::endl;
+        return 1;
+    }
+    size_t repetitions = argc > 1 ? std::stoul(argv[1]) : 5;
+    unsigned long long seed = argc > 2 ? std::stoull(argv[2]) : 2024;
+
+    try {
+        std::vector<CorpusSet> corpus = BuildCorpus(seed);
+
+        // Each test is run against the same witness stream
+        typedef std::function<bool(const Integer&, RandomNumberGenerator&)> Test;
+        PrimalityTester mr10(PrimalityMode::MillerRabin, 10), bpsw0(PrimalityMode::BailliePSW, 0),
+            bpsw1(PrimalityMode::BailliePSW, 1);
+        std::vector<std::pair<std::string, Test>> tests = {
+            {"legacy MR-10", [](const Integer& n, RandomNumberGenerator& rng) { return LegacyIsProbablePrime(n, rng, 10); }},
+            {"MR-10", [&](const Integer& n, RandomNumberGenerator& rng) { return mr10.IsProbablePrime(n, rng); }},
+            {"BPSW", [&](const Integer& n, RandomNumberGenerator& rng) { return bpsw0.IsProbablePrime(n, rng); }},
+            {"BPSW+1", [&](const Integer& n, RandomNumberGenerator& rng) { return bpsw1.IsProbablePrime(n, rng); }},
+        };
+
+        std::cout << std::left << std::setw(16) << "set" << std::right;
+        for (const auto& test : tests) {
+            std::cout << std::setw(16) << test.first + " us";
+        }
+        std::cout << std::endl;
+
+        for (const CorpusSet& set : corpus) {
+            std::cout << std::left << std::setw(16) << set.name << std::right;
+            for (const auto& test : tests) {
+                std::unique_ptr<RandomNumberGenerator> rng = MakeSeededRng(seed, 7, 0);
+                auto start = std::chrono::steady_clock::now();
+                for (size_t r = 0; r < repetitions; r++) {
+                    for (const Integer& n : set.numbers) {
+                        if (test.second(n, *rng) != set.prime) {
+                            throw std::runtime_error(test.first + " misclassified a number in " + set.name);
+                        }
+                    }
+                }
+                auto end = std::chrono::steady_clock::now();
+                double us = std::chrono::duration<double, std::micro>(end - start).count() /
+                            (repetitions * set.numbers.size());
+                std::cout << std::setw(16) << std::fixed << std::setprecision(1) << us;
+            }
+            std::cout << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test bench_primality.cpp prime_search.cpp primality.cpp mod_exp.cpp metrics.cpp -lcryptopp -lpthread
+// ./test 5 2024
@@ -0,0 +1,129 @@
+#include "certificate.h"
+#include "certificate_signer.h"
+
+using namespace CryptoPP;
+
+// Function to return the value at a percentile of a sorted sample
+double Percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = std::min(sorted.size() - 1, size_t(fraction * sorted.size()));
+    return sorted[index];
+}
+
+// Function to time `count` signing requests spaced `gap` apart, checking
+// every signature against the CA key afterwards
+template <typename F>
+std::vector<double> TimeSignatures(F&& sign, size_t count, std::chrono::microseconds gap, const std::string& hash,
+                                   const DSA::Verifier& verifier) {
+    std::vector<double> latencies;
+    std::vector<std::string> signatures;
+    latencies.reserve(count);
+    signatures.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (gap.count() > 0) {
+            std::this_thread::sleep_for(gap);
+        }
+        auto begin = std::chrono::steady_clock::now();
+        signatures.push_back(sign());
+        auto end = std::chrono::steady_clock::now();
+        latencies.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+    }
+    for (const std::string& signature : signatures) {
+        if (!verifier.VerifyMessage(reinterpret_cast<const byte*>(hash.data()), hash.size(),
+                                    reinterpret_cast<const byte*>(signature.data()), signature.size())) {
+            throw std::runtime_error("Signature failed verification");
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+}
+
+// Function to print one latency row
+void PrintRow(const std::string& name, const std::vector<double>& sorted, const SigningStats* stats) {
+    double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / std::max<size_t>(1, sorted.size());
+    std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(9) << mean << std::setw(9) << Percentile(sorted, 0.50) << std::setw(9)
+              << Percentile(sorted, 0.99) << std::setw(10) << (sorted.empty() ? 0.0 : sorted.back());
+    if (stats) {
+        std::cout << std::setw(9) << stats->pooled << std::setw(9) << stats->inlined;
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 6) {
+        std::cerr << "Usage: " << argv[0] << " [signatures] [pool_depth] [refill_rate] [refill_threads] [gap_us]" << std::endl;
+        return 1;
+    }
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 2000;
+    NoncePoolConfig config;
+    config.depth = argc > 2 ? std::stoul(argv[2]) : 1024;
+    config.refillRate = argc > 3 ? std::stod(argv[3]) : 0;
+    config.refillThreads = argc > 4 ? std::stoul(argv[4]) : 1;
+    std::chrono::microseconds gap(argc > 5 ? std::stol(argv[5]) : 100);
+
+    try {
+        DSA::PrivateKey caPrivateKey;
+        LoadDSAPrivateKey("CA_Priv.bin", caPrivateKey);
+        DSA::PublicKey caPublicKey;
+        caPrivateKey.MakePublicKey(caPublicKey);
+        DSA::Verifier verifier(caPublicKey);
+
+        // Any certificate's message will do; only the nonce changes between signatures
+        AutoSeededRandomPool rng;
+        Integer subject;
+        subject.Randomize(rng, 2048);
+        std::string hash = HashCertificateData(CertificateData(subject));
+        ModExpContext ctx(caPrivateKey.GetGroupParameters().GetModulus());
+
+        std::cout << "path                mean      p50      p99       max   pooled   inline  (us)" << std::endl;
+
+        // The original path: DSA::Signer computes g^k on every request
+        DSA::Signer signer(caPrivateKey);
+        PrintRow("DSA::Signer", TimeSignatures([&] {
+            std::string signature(signer.MaxSignatureLength(), 0);
+            signature.resize(signer.SignMessage(rng, reinterpret_cast<const byte*>(hash.data()), hash.size(),
+                                                reinterpret_cast<byte*>(&signature[0])));
+            return signature;
+        }, count, gap, hash, verifier), nullptr);
+
+        // The engine without a pool: g^k inline, but from the comb table
+        NoncePoolConfig noPool = config;
+        noPool.depth = 0;
+        SigningEngine inlineEngine(caPrivateKey, noPool);
+        std::vector<double> sample = TimeSignatures([&] { return inlineEngine.SignHash(hash, ctx, rng); }, count,
+                                                    gap, hash, verifier);
+        SigningStats stats = inlineEngine.Stats();
+        PrintRow("engine, no pool", sample, &stats);
+
+        if (config.depth > 0) {
+            // Let the pool fill before the first request, as it would at startup
+            SigningEngine pooledEngine(caPrivateKey, config);
+            auto fillStart = std::chrono::steady_clock::now();
+            while (pooledEngine.Pool()->Available() < pooledEngine.Pool()->Depth()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            double fillSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - fillStart).count();
+
+            sample = TimeSignatures([&] { return pooledEngine.SignHash(hash, ctx, rng); }, count, gap, hash,
+                                    verifier);
+            stats = pooledEngine.Stats();
+            PrintRow("engine, pooled", sample, &stats);
+            std::cout << "pool depth " << config.depth << ", refill rate "
+                      << (config.refillRate > 0 ? std::to_string(long(config.refillRate)) + "/s" : "unpaced") << ", "
+                      << config.refillThreads << " refill threads, filled in " << std::setprecision(3)
+                      << fillSeconds * 1000 << " ms, " << gap.count() << " us between requests" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test bench_signing.cpp certificate.cpp certificate_stream.cpp certificate_signer.cpp fixed_base.cpp mod_exp.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp -lpthread
+// ./test 2000 1024 0 1 100
+// ./test 5000 256 2000 1 0
@@ -0,0 +1,457 @@
+#include "prime_search.h"
+#include "batch_exp.h"
+#include "key_agreement.h"
+#include "certificate.h"
+#include "certificate_signer.h"
+#include "certificate_verifier.h"
+
+using namespace CryptoPP;
+
+// Settings shared by every measurement
+struct SuiteOptions {
+    std::vector<size_t> sizes = {1024, 2048, 3072};
+    std::set<std::string> phases;    // empty runs every phase
+    size_t warmup = 3;
+    size_t repetitions = 20;
+    size_t primeRepetitions = 5;     // prime searches take far longer than the rest
+    unsigned long long seed = 1;
+    std::string format = "table";
+    std::string output;
+};
+
+// Timing summary for one (phase, backend, size); times are microseconds per operation
+struct PhaseResult {
+    std::string phase;
+    std::string backend;
+    size_t bits;
+    size_t samples;
+    double mean, stddev, min, p50, p90, p99, max;
+};
+
+// One deterministic parameter set with a CA and two certified parties
+struct SuiteGroup {
+    size_t bits;
+    Integer p, q, g;
+    DSA::PrivateKey caPrivateKey;
+    DSA::PublicKey caPublicKey;
+    Integer alicePrivate, alicePublic, bobPrivate, bobPublic;
+    std::string aliceCertificate, bobCertificate;
+};
+
+static const char* const kPhases[] = {"prime", "primality", "modexp", "keygen", "certificate", "verify", "session"};
+
+// Streams of the seeded generator, so each phase draws its own numbers
+enum SuiteStream : unsigned long long { kSetupStream = 1, kWorkStream };
+
+// Function to summarise samples; percentiles use the nearest-rank method
+PhaseResult Summarise(const std::string& phase, const std::string& backend, size_t bits, std::vector<double> samples) {
+    PhaseResult result = {phase, backend, bits, samples.size(), 0, 0, 0, 0, 0, 0, 0};
+    std::sort(samples.begin(), samples.end());
+    for (double s : samples) {
+        result.mean += s;
+    }
+    result.mean /= samples.size();
+    for (double s : samples) {
+        result.stddev += (s - result.mean) * (s - result.mean);
+    }
+    result.stddev = samples.size() > 1 ? std::sqrt(result.stddev / (samples.size() - 1)) : 0;
+    auto percentile = [&](double fraction) {
+        size_t rank = size_t(std::ceil(fraction * samples.size()));
+        return samples[std::min(samples.size(), std::max<size_t>(rank, 1)) - 1];
+    };
+    result.min = samples.front();
+    result.p50 = percentile(0.50);
+    result.p90 = percentile(0.90);
+    result.p99 = percentile(0.99);
+    result.max = samples.back();
+    return result;
+}
+
+// Function to time `op(i)` for `repetitions` values of i after `warmup`
+// untimed calls; each call performs `opsPerCall` operations
+template <typename F>
+PhaseResult Measure(const std::string& phase, const std::string& backend, size_t bits, size_t warmup,
+                    size_t repetitions, F&& op, size_t opsPerCall = 1) {
+    for (size_t i = 0; i < warmup; i++) {
+        op(repetitions + i);
+    }
+    std::vector<double> samples(repetitions);
+    for (size_t i = 0; i < repetitions; i++) {
+        auto start = std::chrono::steady_clock::now();
+        op(i);
+        auto end = std::chrono::steady_clock::now();
+        samples[i] = std::chrono::duration<double, std::micro>(end - start).count() / opsPerCall;
+    }
+    return Summarise(phase, backend, bits, samples);
+}
+
+// Function to build a DSA-style group with a 256-bit q and a CA, Alice
+// and Bob in it, all derived from the seed so every machine sees the same numbers
+SuiteGroup BuildGroup(size_t bits, unsigned long long seed) {
+    SuiteGroup group;
+    group.bits = bits;
+
+    // A seeded search returns the same prime for any thread count
+    PrimeSearchOptions search;
+    search.deterministic = true;
+    search.seed = seed;
+    search.threads = std::max(1u, std::thread::hardware_concurrency());
+    group.q = GeneratePrime(256, search);
+    group.p = GeneratePrimeWithCondition(bits, group.q, search);
+    for (Integer h = 2;; ++h) {
+        group.g = ModExp(h, (group.p - 1) / group.q, group.p);
+        if (group.g != Integer::One()) {
+            break;
+        }
+    }
+
+    std::unique_ptr<RandomNumberGenerator> rng = MakeSeededRng(seed, kSetupStream, bits);
+    DL_GroupParameters_DSA params;
+    params.Initialize(group.p, group.q, group.g);
+    Integer caSecret;
+    caSecret.Randomize(*rng, 1, group.q - 1);
+    group.caPrivateKey.Initialize(params, caSecret);
+    group.caPrivateKey.MakePublicKey(group.caPublicKey);
+
+    group.alicePrivate.Randomize(*rng, 1, group.q - 1);
+    group.bobPrivate.Randomize(*rng, 1, group.q - 1);
+    group.alicePublic = ModExp(group.g, group.alicePrivate, group.p);
+    group.bobPublic = ModExp(group.g, group.bobPrivate, group.p);
+    DSA::Signer signer(group.caPrivateKey);
+    group.aliceCertificate = IssueCertificate(group.alicePublic, signer, *rng);
+    group.bobCertificate = IssueCertificate(group.bobPublic, signer, *rng);
+    return group;
+}
+
+// Function to measure every phase that depends on the modulus size
+void RunGroupPhases(const SuiteGroup& group, const SuiteOptions& options,
+                    const std::function<bool(const std::string&)>& selected, std::vector<PhaseResult>& results) {
+    const size_t bits = group.bits;
+    const size_t reps = options.repetitions;
+    const size_t warmup = options.warmup;
+    std::unique_ptr<RandomNumberGenerator> rng = MakeSeededRng(options.seed, kWorkStream, bits);
+
+    if (selected("prime")) {
+        // Each repetition searches from its own seed, so samples differ but repeat across runs
+        for (PrimalityMode mode : {PrimalityMode::MillerRabin, PrimalityMode::BailliePSW}) {
+            PrimeSearchOptions search;
+            search.deterministic = true;
+            search.primality = mode;
+            results.push_back(Measure("prime", mode == PrimalityMode::MillerRabin ? "miller-rabin" : "bpsw", bits,
+                                      std::min<size_t>(warmup, 1), options.primeRepetitions, [&](size_t i) {
+                search.seed = options.seed + i;
+                GeneratePrime(bits, search);
+            }));
+        }
+    }
+
+    if (selected("primality")) {
+        // A prime runs every round, which is the worst case for the tester
+        for (PrimalityMode mode : {PrimalityMode::MillerRabin, PrimalityMode::BailliePSW}) {
+            PrimalityTester tester(mode, mode == PrimalityMode::MillerRabin ? 10 : 2);
+            results.push_back(Measure("primality", mode == PrimalityMode::MillerRabin ? "miller-rabin" : "bpsw", bits,
+                                      warmup, reps, [&](size_t) {
+                if (!tester.IsProbablePrime(group.p, *rng)) {
+                    throw std::runtime_error("Primality test rejected the group prime");
+                }
+            }));
+        }
+    }
+
+    if (selected("modexp")) {
+        // Private-key-sized exponents below q, as in key agreement
+        std::vector<Integer> bases(reps + warmup), exponents(reps + warmup), expected(reps + warmup);
+        for (size_t i = 0; i < bases.size(); i++) {
+            bases[i].Randomize(*rng, 2, group.p - 2);
+            exponents[i].Randomize(*rng, 1, group.q - 1);
+            expected[i] = ModExp(bases[i], exponents[i], group.p);
+        }
+        ModExpContext ctx(group.p);
+        SecretExpContext secret(group.p);
+        size_t exponentBits = group.q.BitCount();
+        auto check = [&](const Integer& value, size_t i) {
+            if (value != expected[i]) {
+                throw std::runtime_error("Exponentiation engines disagree");
+            }
+        };
+        results.push_back(Measure("modexp", "ModExp", bits, warmup, reps, [&](size_t i) {
+            check(ModExp(bases[i], exponents[i], group.p), i);
+        }));
+        results.push_back(Measure("modexp", "ModExpContext", bits, warmup, reps, [&](size_t i) {
+            check(ctx.Exp(bases[i], exponents[i]), i);
+        }));
+        results.push_back(Measure("modexp", "SecretExpContext", bits, warmup, reps, [&](size_t i) {
+            check(secret.Exp(bases[i], exponents[i], exponentBits), i);
+        }));
+        // One sample is a full set of lanes, reported per exponentiation
+        BatchExpContext batch(group.p);
+        size_t lanes = batch.Lanes();
+        std::vector<Integer> laneBases(lanes), laneExponents(lanes), laneResults(lanes);
+        results.push_back(Measure("modexp", std::string("BatchExpContext/") + BatchKernelName(batch.Kernel()), bits,
+                                  warmup, reps, [&](size_t i) {
+            for (size_t l = 0; l < lanes; l++) {
+                laneBases[l] = bases[(i + l) % bases.size()];
+                laneExponents[l] = exponents[(i + l) % bases.size()];
+            }
+            batch.Exp(laneBases, laneExponents, exponentBits, laneResults);
+            check(laneResults[0], i % bases.size());
+        }, lanes));
+    }
+
+    if (selected("keygen")) {
+        // Private key plus public key, without and with a comb table for g
+        FixedBaseTable table;
+        table.Build(group.g, group.p, group.q.BitCount(), 8);
+        ModpBackend plain(group.p, group.q, group.g);
+        ModpBackend comb(group.p, group.q, group.g, &table);
+        SecByteBlock privateKey(plain.PrivateKeyLength()), publicKey(plain.PublicKeyLength());
+        results.push_back(Measure("keygen", "modp", bits, warmup, reps, [&](size_t) {
+            plain.GenerateKeyPair(*rng, privateKey, publicKey);
+        }));
+        results.push_back(Measure("keygen", "modp-comb", bits, warmup, reps, [&](size_t) {
+            comb.GenerateKeyPair(*rng, privateKey, publicKey);
+        }));
+    }
+
+    if (selected("certificate")) {
+        // The one-shot path of Generate_Certificate, and the engine that
+        // computes g^k from a comb table (no nonce pool, so g^k is on the clock)
+        DSA::Signer signer(group.caPrivateKey);
+        NoncePoolConfig noPool;
+        noPool.depth = 0;
+        SigningEngine engine(group.caPrivateKey, noPool);
+        ModExpContext ctx(group.p);
+        results.push_back(Measure("certificate", "dsa-signer", bits, warmup, reps, [&](size_t) {
+            IssueCertificate(group.alicePublic, signer, *rng);
+        }));
+        results.push_back(Measure("certificate", "signing-engine", bits, warmup, reps, [&](size_t) {
+            engine.Issue(group.alicePublic, false, ctx, *rng);
+        }));
+    }
+
+    if (selected("verify")) {
+        DSA::Verifier verifier(group.caPublicKey);
+        CertificateVerifier engine(group.caPublicKey);
+        ModExpContext ctx(group.p);
+        results.push_back(Measure("verify", "dsa-verifier", bits, warmup, reps, [&](size_t) {
+            if (!VerifyCertificateSignature(group.aliceCertificate, verifier)) {
+                throw std::runtime_error("Certificate failed DSA::Verifier");
+            }
+        }));
+        results.push_back(Measure("verify", "certificate-verifier", bits, warmup, reps, [&](size_t) {
+            if (!engine.Verify(group.aliceCertificate, ctx)) {
+                throw std::runtime_error("Certificate failed CertificateVerifier");
+            }
+        }));
+    }
+
+    if (selected("session")) {
+        // What sessionKeyGen does after loading files: read the peer's key
+        // from its certificate and agree, checked against the other side
+        ModpBackend backend(group.p, group.q, group.g);
+        size_t keyLength = backend.PrivateKeyLength(), publicLength = backend.PublicKeyLength();
+        SecByteBlock alicePrivate(keyLength), bobPrivate(keyLength), peer(publicLength), agreed(backend.AgreedValueLength()),
+            expected(backend.AgreedValueLength());
+        IntegerToKey(group.alicePrivate, alicePrivate, keyLength);
+        IntegerToKey(group.bobPrivate, bobPrivate, keyLength);
+        IntegerToKey(group.alicePublic, peer, publicLength);
+        backend.Agree(expected, bobPrivate, peer);
+        results.push_back(Measure("session", "modp", bits, warmup, reps, [&](size_t) {
+            IntegerToKey(CertificatePublicKey(group.bobCertificate), peer, publicLength);
+            if (!backend.Agree(agreed, alicePrivate, peer) || agreed != expected) {
+                throw std::runtime_error("Session keys differ between Alice and Bob");
+            }
+        }));
+    }
+}
+
+// Function to measure key generation and session derivation for the
+// curve backends, which have one size each; certificates come from `group`
+void RunCurvePhases(const SuiteGroup& group, const SuiteOptions& options,
+                    const std::function<bool(const std::string&)>& selected, std::vector<PhaseResult>& results) {
+    std::unique_ptr<RandomNumberGenerator> rng = MakeSeededRng(options.seed, kWorkStream, 0);
+    DSA::Signer signer(group.caPrivateKey);
+    std::unique_ptr<KeyAgreementBackend> curves[] = {std::unique_ptr<KeyAgreementBackend>(new X25519Backend()),
+                                                     std::unique_ptr<KeyAgreementBackend>(new P256Backend())};
+    for (const std::unique_ptr<KeyAgreementBackend>& backend : curves) {
+        size_t bits = backend->Name() == "x25519" ? 255 : 256;
+        SecByteBlock alicePrivate(backend->PrivateKeyLength()), alicePublic(backend->PublicKeyLength()),
+            bobPrivate(backend->PrivateKeyLength()), bobPublic(backend->PublicKeyLength()),
+            peer(backend->PublicKeyLength()), agreed(backend->AgreedValueLength()),
+            expected(backend->AgreedValueLength());
+        backend->GenerateKeyPair(*rng, alicePrivate, alicePublic);
+        backend->GenerateKeyPair(*rng, bobPrivate, bobPublic);
+        backend->Agree(expected, bobPrivate, alicePublic);
+        std::string bobCertificate = IssueCertificate(KeyToInteger(bobPublic, bobPublic.size()), signer, *rng);
+
+        if (selected("keygen")) {
+            SecByteBlock privateKey(backend->PrivateKeyLength()), publicKey(backend->PublicKeyLength());
+            results.push_back(Measure("keygen", backend->Name(), bits, options.warmup, options.repetitions, [&](size_t) {
+                backend->GenerateKeyPair(*rng, privateKey, publicKey);
+            }));
+        }
+        if (selected("session")) {
+            results.push_back(Measure("session", backend->Name(), bits, options.warmup, options.repetitions, [&](size_t) {
+                IntegerToKey(CertificatePublicKey(bobCertificate), peer, peer.size());
+                if (!backend->Agree(agreed, alicePrivate, peer) || agreed != expected) {
+                    throw std::runtime_error("Session keys differ between Alice and Bob");
+                }
+            }));
+        }
+    }
+}
+
+// Function to print results as an aligned table
+void WriteTable(std::ostream& out, const std::vector<PhaseResult>& results) {
+    out << std::left << std::setw(12) << "phase" << std::setw(28) << "backend" << std::right << std::setw(6) << "bits"
+        << std::setw(5) << "n" << std::setw(12) << "mean us" << std::setw(12) << "p50 us" << std::setw(12) << "p90 us"
+        << std::setw(12) << "p99 us" << std::setw(12) << "max us" << std::endl;
+    for (const PhaseResult& r : results) {
+        out << std::left << std::setw(12) << r.phase << std::setw(28) << r.backend << std::right << std::setw(6) << r.bits
+            << std::setw(5) << r.samples << std::fixed << std::setprecision(1) << std::setw(12) << r.mean
+            << std::setw(12) << r.p50 << std::setw(12) << r.p90 << std::setw(12) << r.p99 << std::setw(12) << r.max
+            << std::endl;
+    }
+}
+
+// Function to print results as CSV with a header row
+void WriteCsv(std::ostream& out, const std::vector<PhaseResult>& results) {
+    out << "phase,backend,bits,samples,mean_us,stddev_us,min_us,p50_us,p90_us,p99_us,max_us" << std::endl;
+    out << std::fixed << std::setprecision(3);
+    for (const PhaseResult& r : results) {
+        out << r.phase << ',' << r.backend << ',' << r.bits << ',' << r.samples << ',' << r.mean << ',' << r.stddev
+            << ',' << r.min << ',' << r.p50 << ',' << r.p90 << ',' << r.p99 << ',' << r.max << std::endl;
+    }
+}
+
+// Function to print results as one JSON document, with the settings that
+// make two runs comparable
+void WriteJson(std::ostream& out, const std::vector<PhaseResult>& results, const SuiteOptions& options) {
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"seed\": " << options.seed << ",\n  \"warmup\": " << options.warmup << ",\n  \"repetitions\": "
+        << options.repetitions << ",\n  \"prime_repetitions\": " << options.primeRepetitions
+        << ",\n  \"batch_kernel\": \"" << BatchKernelName(DetectBatchKernel()) << "\",\n  \"unit\": \"us\",\n"
+        << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const PhaseResult& r = results[i];
+        out << (i ? "," : "") << "\n    {\"phase\": \"" << r.phase << "\", \"backend\": \"" << r.backend
+            << "\", \"bits\": " << r.bits << ", \"samples\": " << r.samples << ", \"mean\": " << r.mean
+            << ", \"stddev\": " << r.stddev << ", \"min\": " << r.min << ", \"p50\": " << r.p50 << ", \"p90\": " << r.p90
+            << ", \"p99\": " << r.p99 << ", \"max\": " << r.max << "}";
+    }
+    out << "\n  ]\n}" << std::endl;
+}
+
+// Function to split a comma-separated list
+std::vector<std::string> SplitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--sizes 1024,2048,3072] [--phases list] [--reps n] [--warmup n]"
+              << " [--prime-reps n] [--seed n] [--format table|json|csv] [--output file]" << std::endl;
+    std::cerr << "Phases:";
+    for (const char* phase : kPhases) {
+        std::cerr << ' ' << phase;
+    }
+    std::cerr << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    SuiteOptions options;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string flag = argv[i];
+            if (i + 1 >= argc) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (flag == "--sizes") {
+                options.sizes.clear();
+                for (const std::string& size : SplitList(value)) {
+                    options.sizes.push_back(std::stoul(size));
+                }
+            } else if (flag == "--phases") {
+                for (const std::string& phase : SplitList(value)) {
+                    if (std::find(std::begin(kPhases), std::end(kPhases), phase) == std::end(kPhases)) {
+                        throw std::invalid_argument("unknown phase " + phase);
+                    }
+                    options.phases.insert(phase);
+                }
+            } else if (flag == "--reps") {
+                options.repetitions = std::stoul(value);
+            } else if (flag == "--warmup") {
+                options.warmup = std::stoul(value);
+            } else if (flag == "--prime-reps") {
+                options.primeRepetitions = std::stoul(value);
+            } else if (flag == "--seed") {
+                options.seed = std::stoull(value);
+            } else if (flag == "--format" && (value == "table" || value == "json" || value == "csv")) {
+                options.format = value;
+            } else if (flag == "--output") {
+                options.output = value;
+            } else {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        if (options.repetitions == 0 || options.primeRepetitions == 0 || options.sizes.empty()) {
+            throw std::invalid_argument("repetitions and sizes must not be empty");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    auto selected = [&](const std::string& phase) { return options.phases.empty() || options.phases.count(phase) > 0; };
+    std::vector<PhaseResult> results;
+    try {
+        std::unique_ptr<SuiteGroup> first;
+        for (size_t bits : options.sizes) {
+            // Setup is untimed; progress goes to stderr so stdout stays machine-readable
+            std::cerr << "Setting up " << bits << "-bit group (seed " << options.seed << ")" << std::endl;
+            std::unique_ptr<SuiteGroup> group(new SuiteGroup(BuildGroup(bits, options.seed)));
+            RunGroupPhases(*group, options, selected, results);
+            if (!first) {
+                first = std::move(group);
+            }
+        }
+        if (selected("keygen") || selected("session")) {
+            RunCurvePhases(*first, options, selected, results);
+        }
+
+        std::ofstream file;
+        if (!options.output.empty()) {
+            file.open(options.output);
+            if (!file) {
+                throw std::runtime_error("Unable to open file for writing: " + options.output);
+            }
+        }
+        std::ostream& out = options.output.empty() ? std::cout : file;
+        if (options.format == "json") {
+            WriteJson(out, results, options);
+        } else if (options.format == "csv") {
+            WriteCsv(out, results);
+        } else {
+            WriteTable(out, results);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test bench_suite.cpp prime_search.cpp primality.cpp batch_exp.cpp key_agreement.cpp named_groups.cpp certificate.cpp certificate_stream.cpp certificate_signer.cpp certificate_verifier.cpp certificate_cache.cpp fixed_base.cpp secret_exp.cpp mod_exp.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp -lpthread
+// ./test --sizes 1024,2048 --reps 50 --format json --output bench.json
@@ -0,0 +1,246 @@
+#include "certificate.h"
+#include "certificate_stream.h"
+#include "dh_container.h"
+#include "metrics.h"
+
+// Function to read certificate file
+std::string ReadFile(const std::string& filename) {
+    DH_METRIC_TIME("dh_file_read_seconds", "Time reading certificate files");
+    MappedFile file(filename);
+    if (IsContainer(file.Data(), file.Size())) {
+        ContainerReader reader(file);
+        ContainerRecord record;
+        do {
+            if (!reader.Next(record)) {
+                throw std::runtime_error("No certificate record in container " + filename);
+            }
+        } while (record.type != RecordType::Certificate);
+        CryptoPP::Integer publicKey;
+        std::string signature;
+        ReadCertificateRecord(record, filename, publicKey, signature);
+        return FormatCertificate(publicKey, signature);
+    }
+    return std::string(reinterpret_cast<const char*>(file.Data()), file.Size());
+}
+
+// Function to build the signed part of a certificate for a public key
+std::string CertificateData(const CryptoPP::Integer& publicKey) {
+    std::ostringstream oss;
+    oss << publicKey; // Decimal, with Crypto++'s trailing '.'
+    return kCertificateHeader + oss.str();
+}
+
+// Function to build the text certificate from a public key and DSA signature
+std::string FormatCertificate(const CryptoPP::Integer& publicKey, const std::string& signature) {
+    std::string encoded;
+    CryptoPP::StringSource ss(signature, true, new CryptoPP::Base64Encoder(new CryptoPP::StringSink(encoded)));
+    return CertificateData(publicKey) + kSignatureDelimiter + encoded;
+}
+
+// Function to split a text certificate into its public key and raw DSA signature
+void ParseCertificate(const std::string& certificate, CryptoPP::Integer& publicKey, std::string& signature) {
+    std::string data, encoded;
+    ExtractDataAndSignature(certificate, data, encoded);
+    publicKey = ExtractPublicKey(data);
+    signature.clear();
+    CryptoPP::StringSource ss(encoded, true, new CryptoPP::Base64Decoder(new CryptoPP::StringSink(signature)));
+}
+
+// Function to extract data and signature from certificate
+void ExtractDataAndSignature(const std::string& certificate, std::string& data, std::string& signature) {
+    std::string delimiter = kSignatureDelimiter;
+    size_t pos = certificate.find(delimiter);
+    if (pos == std::string::npos) {
+        throw std::runtime_error("Invalid certificate format");
+    }
+    data = certificate.substr(0, pos);
+    signature = certificate.substr(pos + delimiter.length());
+}
+
+// Function to extract the public key from the given string
+CryptoPP::Integer ExtractPublicKey(const std::string& input) {
+    std::string keyString;
+
+    // Find the part of the input that contains the public key
+    std::string::size_type startPos = input.find("Subject PublicKey:");
+    if (startPos != std::string::npos) {
+        // Move past the label "Subject PublicKey:"
+        startPos += std::strlen("Subject PublicKey:");
+
+        // Extract the public key part
+        std::string::size_type endPos = input.find_first_of("0123456789", startPos);
+        if (endPos != std::string::npos) {
+            keyString = input.substr(endPos);
+
+            // Trim any leading or trailing whitespace
+            keyString.erase(0, keyString.find_first_not_of(" \n\r\t"));
+            keyString.erase(keyString.find_last_not_of(" \n\r\t") + 1);
+
+            // Convert the decimal string to CryptoPP::Integer
+            return CryptoPP::Integer(keyString.c_str());
+        } else {
+            throw std::runtime_error("Public key not found in the input string.");
+        }
+    } else {
+        throw std::runtime_error("Public key label not found in the input string.");
+    }
+}
+
+// Function to read a 2-byte big-endian length
+static size_t ReadLength16(const CryptoPP::byte* p) {
+    return (size_t(p[0]) << 8) | p[1];
+}
+
+// Function to append a 2-byte big-endian length
+static void AppendLength16(std::string& out, size_t length) {
+    if (length > 0xffff) {
+        throw std::runtime_error("Certificate field too long");
+    }
+    out.push_back(char(length >> 8));
+    out.push_back(char(length));
+}
+
+// Function to check whether certificate bytes use the binary format
+bool IsBinaryCertificate(const std::string& certificate) {
+    return certificate.size() >= sizeof(kBinaryMagic) &&
+           std::memcmp(certificate.data(), kBinaryMagic, sizeof(kBinaryMagic)) == 0;
+}
+
+// Function to parse a binary certificate into views of the buffer; throws if it is malformed
+void ParseBinaryCertificate(const CryptoPP::byte* data, size_t size, CertificateView& view) {
+    const size_t header = sizeof(kBinaryMagic) + 4;
+    if (size < header || std::memcmp(data, kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+        throw std::runtime_error("Invalid binary certificate header");
+    }
+    if (data[4] != kBinaryVersion || data[5] != kAlgorithmDsaSha256) {
+        throw std::runtime_error("Unsupported binary certificate version or algorithm");
+    }
+
+    view.publicKeySize = ReadLength16(data + 6);
+    view.publicKey = data + header;
+    size_t offset = header + view.publicKeySize;
+    if (view.publicKeySize == 0 || offset + 2 > size) {
+        throw std::runtime_error("Truncated binary certificate public key");
+    }
+    view.signedData = data;
+    view.signedDataSize = offset;
+
+    view.signatureSize = ReadLength16(data + offset);
+    view.signature = data + offset + 2;
+    if (offset + 2 + view.signatureSize != size) {
+        throw std::runtime_error("Binary certificate signature length does not match the file");
+    }
+}
+
+// Function to build the signed part of a binary certificate
+std::string BinaryCertificateData(const CryptoPP::Integer& publicKey) {
+    std::string data(kBinaryMagic, sizeof(kBinaryMagic));
+    data.push_back(char(kBinaryVersion));
+    data.push_back(char(kAlgorithmDsaSha256));
+    size_t size = publicKey.MinEncodedSize();
+    AppendLength16(data, size);
+    size_t offset = data.size();
+    data.resize(offset + size);
+    publicKey.Encode(reinterpret_cast<CryptoPP::byte*>(&data[offset]), size);
+    return data;
+}
+
+// Function to append the length-prefixed signature that completes a binary certificate
+void AppendBinarySignature(std::string& certificate, const std::string& signature) {
+    AppendLength16(certificate, signature.size());
+    certificate.append(signature);
+}
+
+// Function to get the subject public key of a text or binary certificate
+CryptoPP::Integer CertificatePublicKey(const std::string& certificate) {
+    CertificateArena arena;
+    CertificateFields fields;
+    ReadCertificateFields(reinterpret_cast<const CryptoPP::byte*>(certificate.data()), certificate.size(), arena,
+                          fields);
+    return CryptoPP::Integer(fields.publicKey, fields.publicKeySize);
+}
+
+// Function to get the SHA-256 message the CA signed and the raw DSA
+// signature of a text or binary certificate
+void CertificateMessage(const std::string& certificate, std::string& hash, std::string& signature) {
+    CertificateArena arena;
+    CertificateFields fields;
+    ReadCertificateFields(reinterpret_cast<const CryptoPP::byte*>(certificate.data()), certificate.size(), arena,
+                          fields);
+    hash.resize(CryptoPP::SHA256::DIGESTSIZE);
+    HashSignedData(fields, reinterpret_cast<CryptoPP::byte*>(&hash[0]));
+    signature.assign(reinterpret_cast<const char*>(fields.signature), fields.signatureSize);
+}
+
+// Function to load a DSA private key from a file
+void LoadDSAPrivateKey(const std::string& filename, CryptoPP::DSA::PrivateKey& key) {
+    CryptoPP::FileSource file(filename.c_str(), true);
+    key.Load(file);
+}
+
+// Function to load a DSA public key from a file
+void LoadDSAPublicKey(const std::string& filename, CryptoPP::DSA::PublicKey& key) {
+    CryptoPP::FileSource file(filename.c_str(), true);
+    key.Load(file);
+}
+
+// Function to hash certificate data with SHA-256
+std::string HashCertificateData(const std::string& certData) {
+    std::string hash;
+    CryptoPP::SHA256 hashFunction;
+    CryptoPP::StringSource(certData, true, new CryptoPP::HashFilter(hashFunction, new CryptoPP::StringSink(hash)));
+    return hash;
+}
+
+// Function to reduce a signed message to the integer DSA works with
+CryptoPP::Integer DsaMessageRepresentative(const CryptoPP::byte* message, size_t size, const CryptoPP::Integer& q) {
+    CryptoPP::byte digest[CryptoPP::SHA1::DIGESTSIZE];
+    CryptoPP::SHA1().CalculateDigest(digest, message, size);
+    CryptoPP::Integer e(digest, sizeof(digest));
+    if (q.BitCount() < 8 * sizeof(digest)) {
+        e >>= 8 * sizeof(digest) - q.BitCount();
+    }
+    return e;
+}
+
+CryptoPP::Integer DsaMessageRepresentative(const std::string& message, const CryptoPP::Integer& q) {
+    return DsaMessageRepresentative(reinterpret_cast<const CryptoPP::byte*>(message.data()), message.size(), q);
+}
+
+// Function to build, hash and sign a certificate in one pass through an arena
+static std::string StreamCertificate(const CryptoPP::Integer& publicKey, bool binary,
+                                     const CryptoPP::DSA::Signer& signer, CryptoPP::RandomNumberGenerator& rng) {
+    DH_METRIC_TIME("dh_certificate_issue_seconds", "Time building, hashing and signing one certificate");
+    CertificateArena arena;
+    CertificateStreamWriter writer(arena, binary);
+    CryptoPP::byte hash[CryptoPP::SHA256::DIGESTSIZE];
+    writer.WriteSignedPart(publicKey, signer.MaxSignatureLength(), hash);
+    size_t length = signer.SignMessage(rng, hash, sizeof(hash), writer.SignatureBuffer());
+    writer.WriteSignature(writer.SignatureBuffer(), length);
+    return writer.ToString();
+}
+
+// Function to issue a certificate: the SHA-256 hash of the certificate
+// data, signed with the CA's DSA key
+std::string IssueCertificate(const CryptoPP::Integer& publicKey, const CryptoPP::DSA::Signer& signer,
+                             CryptoPP::RandomNumberGenerator& rng) {
+    return StreamCertificate(publicKey, false, signer, rng);
+}
+
+// Function to issue a binary certificate for a public key
+std::string IssueBinaryCertificate(const CryptoPP::Integer& publicKey, const CryptoPP::DSA::Signer& signer,
+                                   CryptoPP::RandomNumberGenerator& rng) {
+    return StreamCertificate(publicKey, true, signer, rng);
+}
+
+// Function to check a certificate's signature against the CA's DSA key
+bool VerifyCertificateSignature(const std::string& certificate, const CryptoPP::DSA::Verifier& verifier) {
+    DH_METRIC_TIME("dh_certificate_verify_seconds", "Time parsing and verifying one certificate");
+    CertificateArena arena;
+    CertificateFields fields;
+    ReadCertificateFields(reinterpret_cast<const CryptoPP::byte*>(certificate.data()), certificate.size(), arena,
+                          fields);
+    CryptoPP::byte hash[CryptoPP::SHA256::DIGESTSIZE];
+    HashSignedData(fields, hash);
+    return verifier.VerifyMessage(hash, sizeof(hash), fields.signature, fields.signatureSize);
+}
@@ -0,0 +1,96 @@
+#ifndef CERTIFICATE_H
+#define CERTIFICATE_H
+
+#include "crypto_headers.h"
+
+// Fixed text of the text certificate format
+static const char kCertificateHeader[] = "Signature Algorithm: DSA\nSubject PublicKey:\n";
+static const char kSignatureDelimiter[] = "\nSignature:\n";
+
+// Function to read certificate file; from a container, the first
+// certificate record is rendered back into the text form
+std::string ReadFile(const std::string& filename);
+
+// Function to build the signed part of a certificate for a public key
+std::string CertificateData(const CryptoPP::Integer& publicKey);
+
+// Function to build the text certificate from a public key and DSA signature
+std::string FormatCertificate(const CryptoPP::Integer& publicKey, const std::string& signature);
+
+// Function to split a text certificate into its public key and raw DSA signature
+void ParseCertificate(const std::string& certificate, CryptoPP::Integer& publicKey, std::string& signature);
+
+// Function to extract data and signature from certificate
+void ExtractDataAndSignature(const std::string& certificate, std::string& data, std::string& signature);
+
+// Function to extract the public key from the given string
+CryptoPP::Integer ExtractPublicKey(const std::string& input);
+
+// Binary certificate: fixed field order, big-endian lengths, raw key and
+// signature bytes, so a parser only has to bounds-check and point into
+// the buffer instead of converting decimal text and Base64.
+//
+//   "DHBC" | version (1) | algorithm (1) | key length (2) | public key |
+//   signature length (2) | signature
+//
+// The CA signs the SHA-256 of everything before the signature length.
+static const char kBinaryMagic[4] = {'D', 'H', 'B', 'C'};
+static const CryptoPP::byte kBinaryVersion = 1;
+static const CryptoPP::byte kAlgorithmDsaSha256 = 1;
+
+struct CertificateView {
+    const CryptoPP::byte* publicKey;
+    size_t publicKeySize;
+    const CryptoPP::byte* signature;
+    size_t signatureSize;
+    const CryptoPP::byte* signedData;
+    size_t signedDataSize;
+};
+
+// Function to check whether certificate bytes use the binary format
+bool IsBinaryCertificate(const std::string& certificate);
+
+// Function to parse a binary certificate into views of the buffer; throws if it is malformed
+void ParseBinaryCertificate(const CryptoPP::byte* data, size_t size, CertificateView& view);
+
+// Function to build the signed part of a binary certificate
+std::string BinaryCertificateData(const CryptoPP::Integer& publicKey);
+
+// Function to append the length-prefixed signature that completes a binary certificate
+void AppendBinarySignature(std::string& certificate, const std::string& signature);
+
+// Function to get the subject public key of a text or binary certificate
+CryptoPP::Integer CertificatePublicKey(const std::string& certificate);
+
+// Function to get the SHA-256 message the CA signed and the raw DSA
+// signature of a text or binary certificate
+void CertificateMessage(const std::string& certificate, std::string& hash, std::string& signature);
+
+// Function to load a DSA private key from a file
+void LoadDSAPrivateKey(const std::string& filename, CryptoPP::DSA::PrivateKey& key);
+
+// Function to load a DSA public key from a file
+void LoadDSAPublicKey(const std::string& filename, CryptoPP::DSA::PublicKey& key);
+
+// Function to hash certificate data with SHA-256; this digest is the message the CA signs
+std::string HashCertificateData(const std::string& certData);
+
+// Function to reduce a signed message to the integer DSA works with: its
+// SHA-1 digest, keeping the leftmost bits up to the bit length of q
+CryptoPP::Integer DsaMessageRepresentative(const CryptoPP::byte* message, size_t size, const CryptoPP::Integer& q);
+CryptoPP::Integer DsaMessageRepresentative(const std::string& message, const CryptoPP::Integer& q);
+
+// Function to issue a certificate: the SHA-256 hash of the certificate
+// data, signed with the CA's DSA key. The certificate is built and hashed
+// in one pass, and the returned string is its only heap allocation.
+std::string IssueCertificate(const CryptoPP::Integer& publicKey, const CryptoPP::DSA::Signer& signer,
+                             CryptoPP::RandomNumberGenerator& rng);
+
+// Function to issue a binary certificate for a public key
+std::string IssueBinaryCertificate(const CryptoPP::Integer& publicKey, const CryptoPP::DSA::Signer& signer,
+                                   CryptoPP::RandomNumberGenerator& rng);
+
+// Function to check a certificate's signature against the CA's DSA key
+bool VerifyCertificateSignature(const std::string& certificate, const CryptoPP::DSA::Verifier& verifier);
+
+#endif // CERTIFICATE_H
@@ -0,0 +1,167 @@
+#include "certificate_cache.h"
+#include "certificate.h"
+#include "dh_container.h"
+#include "metrics.h"
+
+#include <unistd.h>
+
+using namespace CryptoPP;
+
+CertificateCache::CertificateCache(size_t capacity, unsigned int shards)
+    : m_capacity(capacity), m_hits(0), m_misses(0), m_insertions(0), m_evictions(0), m_modified(false) {
+    if (capacity == 0) {
+        throw InvalidArgument("CertificateCache: capacity must be positive");
+    }
+    // No more shards than entries, so every shard holds at least one
+    size_t count = std::max<size_t>(1, std::min<size_t>(shards, capacity));
+    m_shardCapacity = (capacity + count - 1) / count;
+    m_shards = std::vector<Shard>(count);
+}
+
+CertificateDigest CertificateCache::Digest(const std::string& certificate) {
+    CertificateDigest digest;
+    SHA256().CalculateDigest(digest.data(), reinterpret_cast<const byte*>(certificate.data()), certificate.size());
+    return digest;
+}
+
+bool CertificateCache::Lookup(const CertificateDigest& digest, Integer& publicKey) {
+    Shard& shard = ShardFor(digest);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(digest);
+    if (it == shard.index.end()) {
+        m_misses++;
+        DH_METRIC_COUNT("dh_certificate_cache_misses_total", "Certificate cache lookups that missed", 1);
+        return false;
+    }
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    publicKey = it->second->second;
+    m_hits++;
+    DH_METRIC_COUNT("dh_certificate_cache_hits_total", "Certificate cache lookups that hit", 1);
+    return true;
+}
+
+void CertificateCache::Insert(const CertificateDigest& digest, const Integer& publicKey) {
+    Shard& shard = ShardFor(digest);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(digest);
+    if (it != shard.index.end()) {
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        return;
+    }
+
+    if (shard.entries.size() >= m_shardCapacity) {
+        shard.index.erase(shard.entries.back().first);
+        shard.entries.pop_back();
+        m_evictions++;
+    }
+    shard.entries.emplace_front(digest, publicKey);
+    shard.index.emplace(digest, shard.entries.begin());
+    m_insertions++;
+    m_modified = true;
+}
+
+Integer CertificateCache::GetOrVerify(const std::string& certificate, const std::function<bool(const std::string&)>& verify) {
+    CertificateDigest digest = Digest(certificate);
+    Integer publicKey;
+    if (Lookup(digest, publicKey)) {
+        return publicKey;
+    }
+
+    // Verify outside the shard lock; two threads missing on the same
+    // certificate both verify it and the second insert is a no-op
+    if (!verify(certificate)) {
+        throw std::runtime_error("Certificate signature verification failed");
+    }
+    publicKey = CertificatePublicKey(certificate);
+    Insert(digest, publicKey);
+    return publicKey;
+}
+
+CertificateDigest CertificateCache::AuthorityDigest(const DSA::PublicKey& caPublicKey) {
+    std::string encoded;
+    StringSink sink(encoded);
+    caPublicKey.Save(sink);
+    return Digest(encoded);
+}
+
+void CertificateCache::Save(const std::string& filename, const CertificateDigest& authority) {
+    // Write to a temporary file and rename, so a crash never leaves a half-written cache
+    std::string temporary = filename + ".tmp";
+    {
+        ContainerWriter writer(temporary);
+        std::string payload;
+        AppendBytesField(payload, std::string(reinterpret_cast<const char*>(authority.data()), authority.size()));
+        writer.WriteRecord(RecordType::CacheAuthority, payload);
+        for (const Shard& shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.entries.rbegin(); it != shard.entries.rend(); ++it) {
+                payload.clear();
+                AppendBytesField(payload, std::string(reinterpret_cast<const char*>(it->first.data()), it->first.size()));
+                AppendIntegerField(payload, it->second);
+                writer.WriteRecord(RecordType::VerifiedCertificate, payload);
+            }
+        }
+        writer.Close();
+    }
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        throw std::runtime_error("Unable to replace cache file: " + filename);
+    }
+    m_modified = false;
+}
+
+bool CertificateCache::Load(const std::string& filename, const CertificateDigest& authority) {
+    if (access(filename.c_str(), F_OK) != 0) {
+        return false;
+    }
+
+    MappedFile file(filename);
+    ContainerReader reader(file);
+    ContainerRecord record;
+    std::string digestBytes;
+    Integer publicKey;
+
+    // Entries verified against another CA key must not be trusted for this one
+    if (!reader.Next(record) || record.type != RecordType::CacheAuthority) {
+        return false;
+    }
+    FieldReader header(record, filename);
+    header.ReadBytes(digestBytes);
+    header.ExpectEnd();
+    if (digestBytes.size() != authority.size() || std::memcmp(digestBytes.data(), authority.data(), authority.size()) != 0) {
+        return false;
+    }
+
+    // Loaded entries are already on disk, so they leave the modified flag alone
+    bool modified = m_modified;
+    while (reader.Next(record)) {
+        if (record.type != RecordType::VerifiedCertificate) {
+            throw std::runtime_error("Unexpected " + std::string(RecordTypeName(record.type)) + " record in " + filename);
+        }
+        FieldReader fields(record, filename);
+        fields.ReadBytes(digestBytes);
+        fields.ReadInteger(publicKey);
+        fields.ExpectEnd();
+
+        CertificateDigest digest;
+        if (digestBytes.size() != digest.size()) {
+            throw std::runtime_error("Invalid certificate digest in " + filename);
+        }
+        std::memcpy(digest.data(), digestBytes.data(), digest.size());
+        Insert(digest, publicKey);
+    }
+    m_modified = modified;
+    return true;
+}
+
+CertificateCacheStats CertificateCache::Stats() const {
+    CertificateCacheStats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.insertions = m_insertions;
+    stats.evictions = m_evictions;
+    for (const Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.entries += shard.entries.size();
+    }
+    return stats;
+}
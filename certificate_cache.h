@@ -0,0 +1,94 @@
+#ifndef CERTIFICATE_CACHE_H
+#define CERTIFICATE_CACHE_H
+
+#include "crypto_headers.h"
+
+// SHA-256 of the certificate bytes, the cache key
+typedef std::array<CryptoPP::byte, 32> CertificateDigest;
+
+// Counters since the cache was created
+struct CertificateCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t insertions = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+};
+
+// Bounded LRU cache of certificates that have already passed signature
+// verification, mapping the certificate digest to its decoded public key.
+// A hit skips both the Base64/decimal parsing and the DSA check. The
+// cache is split into shards, each an LRU list under its own mutex, so
+// concurrent lookups of different certificates rarely contend.
+//
+// Only insert certificates that verified against the CA key; a persisted
+// cache file is trusted as-is on load, so keep it as private as the keys.
+// A saved file records the digest of that CA key, and loading it for a
+// different key adds nothing.
+class CertificateCache {
+public:
+    explicit CertificateCache(size_t capacity, unsigned int shards = 16);
+
+    CertificateCache(const CertificateCache&) = delete;
+    CertificateCache& operator=(const CertificateCache&) = delete;
+
+    // Function to compute the cache key for a certificate
+    static CertificateDigest Digest(const std::string& certificate);
+
+    // Function to look up a digest; on a hit, copies the public key and marks the entry most recent
+    bool Lookup(const CertificateDigest& digest, CryptoPP::Integer& publicKey);
+
+    // Function to add a verified certificate, evicting the least recently used entry of its shard when full
+    void Insert(const CertificateDigest& digest, const CryptoPP::Integer& publicKey);
+
+    // Function to return a certificate's public key, calling verify(certificate) on a miss.
+    // Throws if verification fails; failed certificates are not cached.
+    CryptoPP::Integer GetOrVerify(const std::string& certificate, const std::function<bool(const std::string&)>& verify);
+
+    // Function to compute the digest that binds a cache file to a CA public key
+    static CertificateDigest AuthorityDigest(const CryptoPP::DSA::PublicKey& caPublicKey);
+
+    // Function to write every entry to a container file, oldest first,
+    // after a record of the CA key they were verified against
+    void Save(const std::string& filename, const CertificateDigest& authority);
+
+    // Function to add the entries of a file written by Save() for the same
+    // CA key; returns false if the file does not exist or was saved for
+    // another key (or by a version that did not record one)
+    bool Load(const std::string& filename, const CertificateDigest& authority);
+
+    // Function to check whether entries were inserted since the last Save()
+    // or the cache was created; Load() does not count
+    bool Modified() const { return m_modified; }
+
+    CertificateCacheStats Stats() const;
+    size_t Capacity() const { return m_capacity; }
+
+private:
+    struct DigestHash {
+        size_t operator()(const CertificateDigest& digest) const {
+            size_t h;
+            std::memcpy(&h, digest.data(), sizeof(h));
+            return h;
+        }
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<std::pair<CertificateDigest, CryptoPP::Integer>> entries; // most recent first
+        std::unordered_map<CertificateDigest, decltype(entries)::iterator, DigestHash> index;
+    };
+
+    Shard& ShardFor(const CertificateDigest& digest) { return m_shards[digest[31] % m_shards.size()]; }
+
+    size_t m_capacity;
+    size_t m_shardCapacity;
+    std::vector<Shard> m_shards;
+    std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_misses;
+    std::atomic<uint64_t> m_insertions;
+    std::atomic<uint64_t> m_evictions;
+    std::atomic<bool> m_modified;
+};
+
+#endif // CERTIFICATE_CACHE_H
@@ -0,0 +1,133 @@
+#include "certificate_signer.h"
+#include "certificate.h"
+#include "certificate_stream.h"
+#include "metrics.h"
+
+using namespace CryptoPP;
+
+// Function to draw a fresh nonce, computing g^k from a comb table for g
+void MakeDsaNonce(const FixedBaseTable& gTable, const Integer& q, const ModExpContext& ctx, RandomNumberGenerator& rng,
+                  DsaNonce& nonce) {
+    do {
+        nonce.k.Randomize(rng, Integer::One(), q - 1);
+        nonce.r = gTable.Exp(nonce.k, ctx) % q;
+    } while (nonce.r.IsZero());
+    nonce.kInverse = nonce.k.InverseMod(q);
+}
+
+NoncePool::NoncePool(const FixedBaseTable& gTable, const Integer& q, const NoncePoolConfig& config)
+    : m_gTable(gTable), m_q(q), m_config(config), m_queue(config.depth) {
+    if (config.depth == 0 || config.refillThreads == 0) {
+        throw InvalidArgument("NoncePool: depth and refill threads must be at least one");
+    }
+    if (config.refillRate < 0) {
+        throw InvalidArgument("NoncePool: negative refill rate");
+    }
+    for (unsigned int i = 0; i < config.refillThreads; i++) {
+        m_producers.emplace_back(&NoncePool::ProducerLoop, this);
+    }
+}
+
+NoncePool::~NoncePool() {
+    m_queue.Close();
+    for (std::thread& producer : m_producers) {
+        producer.join();
+    }
+}
+
+bool NoncePool::TryTake(DsaNonce& nonce) {
+    return m_queue.TryPop(nonce);
+}
+
+void NoncePool::Take(DsaNonce& nonce) {
+    if (!m_queue.Pop(nonce)) {
+        throw std::runtime_error("NoncePool: pool is shut down");
+    }
+}
+
+void NoncePool::ProducerLoop() {
+    // Per-thread Montgomery context and generator; the table is shared
+    ModExpContext ctx(m_gTable.GetModulus());
+    AutoSeededRandomPool rng;
+
+    // Each producer gets an equal share of the refill rate
+    typedef std::chrono::steady_clock Clock;
+    Clock::duration interval = Clock::duration::zero();
+    if (m_config.refillRate > 0) {
+        interval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(m_config.refillThreads / m_config.refillRate));
+    }
+    Clock::time_point next = Clock::now();
+
+    while (true) {
+        if (interval != Clock::duration::zero()) {
+            std::this_thread::sleep_until(next);
+        }
+        DsaNonce nonce;
+        MakeDsaNonce(m_gTable, m_q, ctx, rng, nonce);
+        // Blocks while the pool is full; fails once the pool shuts down
+        if (!m_queue.Push(std::move(nonce))) {
+            return;
+        }
+        // Time spent blocked on a full pool does not bank a burst
+        next = std::max(next + interval, Clock::now());
+    }
+}
+
+SigningEngine::SigningEngine(const DSA::PrivateKey& caKey, const NoncePoolConfig& config, unsigned int teeth)
+    : m_q(caKey.GetGroupParameters().GetSubgroupOrder()), m_x(caKey.GetPrivateExponent()), m_pooled(0), m_inlined(0) {
+    const DL_GroupParameters_DSA& params = caKey.GetGroupParameters();
+    // k < q, so the table only has to cover q's bit length
+    m_gTable.Build(params.GetSubgroupGenerator(), params.GetModulus(), m_q.BitCount(), teeth);
+    if (config.depth > 0) {
+        m_pool.reset(new NoncePool(m_gTable, m_q, config));
+    }
+}
+
+size_t SigningEngine::SignDigest(const byte* hash, size_t size, byte* signature, const ModExpContext& ctx,
+                                 RandomNumberGenerator& rng) const {
+    Integer e = DsaMessageRepresentative(hash, size, m_q);
+    DsaNonce nonce;
+    Integer s;
+    do {
+        if (m_pool && m_pool->TryTake(nonce)) {
+            m_pooled++;
+        } else {
+            MakeDsaNonce(m_gTable, m_q, ctx, rng, nonce);
+            m_inlined++;
+        }
+        s = a_times_b_mod_c(nonce.kInverse, e + m_x * nonce.r, m_q);
+    } while (s.IsZero());
+
+    // r || s, each the width of q, as DSA::Signer lays them out
+    size_t width = m_q.ByteCount();
+    nonce.r.Encode(signature, width);
+    s.Encode(signature + width, width);
+    return 2 * width;
+}
+
+std::string SigningEngine::SignHash(const std::string& hash, const ModExpContext& ctx, RandomNumberGenerator& rng) const {
+    std::string signature(SignatureLength(), 0);
+    SignDigest(reinterpret_cast<const byte*>(hash.data()), hash.size(), reinterpret_cast<byte*>(&signature[0]), ctx,
+               rng);
+    return signature;
+}
+
+std::string SigningEngine::Issue(const Integer& publicKey, bool binary, const ModExpContext& ctx,
+                                 RandomNumberGenerator& rng) const {
+    DH_METRIC_TIME("dh_certificate_issue_seconds", "Time building, hashing and signing one certificate");
+    CertificateArena arena;
+    CertificateStreamWriter writer(arena, binary);
+    byte hash[SHA256::DIGESTSIZE];
+    writer.WriteSignedPart(publicKey, SignatureLength(), hash);
+    size_t length = SignDigest(hash, sizeof(hash), writer.SignatureBuffer(), ctx, rng);
+    writer.WriteSignature(writer.SignatureBuffer(), length);
+    return writer.ToString();
+}
+
+SigningStats SigningEngine::Stats() const {
+    SigningStats stats;
+    stats.pooled = m_pooled;
+    stats.inlined = m_inlined;
+    return stats;
+}
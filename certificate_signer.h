@@ -0,0 +1,105 @@
+#ifndef CERTIFICATE_SIGNER_H
+#define CERTIFICATE_SIGNER_H
+
+#include "fixed_base.h"
+#include "work_queue.h"
+
+// The message-independent half of a DSA signature: the nonce k, its
+// inverse mod q and r = (g^k mod p) mod q. Computing r is the only
+// exponentiation in DSA signing, so with these ready a signature is just
+// s = k^-1 (e + x r) mod q. A nonce must never sign two messages.
+struct DsaNonce {
+    CryptoPP::Integer k;
+    CryptoPP::Integer kInverse;
+    CryptoPP::Integer r;
+};
+
+// Function to draw a fresh nonce, computing g^k from a comb table for g
+void MakeDsaNonce(const FixedBaseTable& gTable, const CryptoPP::Integer& q, const ModExpContext& ctx,
+                  CryptoPP::RandomNumberGenerator& rng, DsaNonce& nonce);
+
+// How the background nonce supply is sized and paced
+struct NoncePoolConfig {
+    size_t depth = 1024;             // nonces kept ready; 0 disables the pool
+    double refillRate = 0;           // nonces/s the producers may make; 0 is unpaced
+    unsigned int refillThreads = 1;
+};
+
+// Background producer of DSA nonces for one CA group. Producer threads
+// share the caller's comb table for g and top the pool back up to `depth`
+// whenever nonces are taken, at no more than `refillRate` nonces/s so a
+// refill burst cannot starve the threads serving requests. Every nonce is
+// handed out exactly once.
+class NoncePool {
+public:
+    NoncePool(const FixedBaseTable& gTable, const CryptoPP::Integer& q, const NoncePoolConfig& config);
+    ~NoncePool();
+
+    NoncePool(const NoncePool&) = delete;
+    NoncePool& operator=(const NoncePool&) = delete;
+
+    // Function to take a nonce if one is ready, without waiting
+    bool TryTake(DsaNonce& nonce);
+
+    // Function to take a nonce, waiting for the producers if the pool is empty
+    void Take(DsaNonce& nonce);
+
+    size_t Depth() const { return m_queue.Capacity(); }
+    size_t Available() const { return m_queue.Size(); }
+    const NoncePoolConfig& Config() const { return m_config; }
+
+private:
+    void ProducerLoop();
+
+    const FixedBaseTable& m_gTable;
+    CryptoPP::Integer m_q;
+    NoncePoolConfig m_config;
+    WorkQueue<DsaNonce> m_queue;
+    std::vector<std::thread> m_producers;
+};
+
+struct SigningStats {
+    unsigned long long pooled = 0;  // signatures that used a precomputed nonce
+    unsigned long long inlined = 0; // signatures that computed g^k on the request path
+};
+
+// Signs certificates with the CA's DSA key. Each signature takes a nonce
+// from the pool if one is ready and otherwise computes g^k inline from the
+// engine's comb table, so an empty pool costs latency but never blocks.
+// Signatures are the r || s that DSA::Signer produces and DSA::Verifier
+// accepts. The engine is shared between threads; each caller passes its
+// own context for the CA modulus and RNG, used only on the inline path.
+class SigningEngine {
+public:
+    SigningEngine(const CryptoPP::DSA::PrivateKey& caKey, const NoncePoolConfig& config, unsigned int teeth = 8);
+
+    // Function to sign a certificate's SHA-256 message into `signature`,
+    // which must hold SignatureLength() bytes; returns the length written
+    size_t SignDigest(const CryptoPP::byte* hash, size_t size, CryptoPP::byte* signature, const ModExpContext& ctx,
+                      CryptoPP::RandomNumberGenerator& rng) const;
+
+    // Function to sign a certificate's SHA-256 message
+    std::string SignHash(const std::string& hash, const ModExpContext& ctx, CryptoPP::RandomNumberGenerator& rng) const;
+
+    // Function to issue a text or binary certificate for a public key,
+    // building and hashing it in one pass through a stack arena
+    std::string Issue(const CryptoPP::Integer& publicKey, bool binary, const ModExpContext& ctx,
+                      CryptoPP::RandomNumberGenerator& rng) const;
+
+    SigningStats Stats() const;
+
+    size_t SignatureLength() const { return 2 * m_q.ByteCount(); }
+
+    const CryptoPP::Integer& GetModulus() const { return m_gTable.GetModulus(); }
+    const NoncePool* Pool() const { return m_pool.get(); }
+
+private:
+    CryptoPP::Integer m_q;
+    CryptoPP::Integer m_x;
+    FixedBaseTable m_gTable;
+    std::unique_ptr<NoncePool> m_pool;
+    mutable std::atomic<unsigned long long> m_pooled;
+    mutable std::atomic<unsigned long long> m_inlined;
+};
+
+#endif // CERTIFICATE_SIGNER_H
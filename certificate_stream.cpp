@@ -0,0 +1,288 @@
+#include "certificate_stream.h"
+#include "certificate.h"
+
+using namespace CryptoPP;
+
+static const char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Base64 line length used by Crypto++'s Base64Encoder
+static const size_t kBase64LineLength = 72;
+
+static const uint32_t kDecimalChunk = 1000000000; // 10^9, nine digits per 32-bit word
+
+// Function to round a size up to a whole number of 32-bit words
+static size_t AlignSize(size_t size) {
+    return (size + 3) & ~size_t(3);
+}
+
+void CertificateArena::Reserve(size_t size) {
+    if (m_used + size <= m_capacity) {
+        return;
+    }
+    if (m_used != 0) {
+        throw std::logic_error("CertificateArena: reserve after allocating");
+    }
+    if (m_heapSize < size) {
+        m_heap.reset(new byte[size]);
+        m_heapSize = size;
+    }
+    m_capacity = m_heapSize;
+}
+
+byte* CertificateArena::Allocate(size_t size) {
+    size = AlignSize(size);
+    if (m_used + size > m_capacity) {
+        throw std::logic_error("CertificateArena: allocation exceeds the reservation");
+    }
+    byte* block = Base() + m_used;
+    m_used += size;
+    return block;
+}
+
+CertificateStreamWriter::CertificateStreamWriter(CertificateArena& arena, bool binary)
+    : m_arena(arena), m_binary(binary), m_out(nullptr), m_signature(nullptr), m_size(0), m_capacity(0) {}
+
+void CertificateStreamWriter::Write(const void* data, size_t size, bool hashed) {
+    byte* out = Reserve(size);
+    std::memcpy(out, data, size);
+    if (hashed) {
+        m_hash.Update(out, size);
+    }
+}
+
+byte* CertificateStreamWriter::Reserve(size_t size) {
+    if (m_size + size > m_capacity) {
+        throw std::runtime_error("Certificate field longer than reserved");
+    }
+    byte* out = m_out + m_size;
+    m_size += size;
+    return out;
+}
+
+void CertificateStreamWriter::WriteSignedPart(const Integer& publicKey, size_t maxSignatureSize, byte* hash) {
+    size_t keyBytes = publicKey.MinEncodedSize();
+    if (keyBytes > 0xffff) {
+        throw std::runtime_error("Certificate field too long");
+    }
+
+    // One reservation covers the whole certificate plus the decimal scratch
+    size_t digits = keyBytes * 241 / 100 + 2; // 8 log10(2) < 2.41 digits per byte
+    size_t words = AlignSize(keyBytes) / 4;
+    size_t chunks = digits / 9 + 1;
+    size_t base64 = 4 * ((maxSignatureSize + 2) / 3);
+    base64 += base64 / kBase64LineLength + 1;
+    size_t output = m_binary
+        ? sizeof(kBinaryMagic) + 4 + keyBytes + 2 + maxSignatureSize
+        : sizeof(kCertificateHeader) - 1 + digits + 1 + sizeof(kSignatureDelimiter) - 1 + base64;
+    size_t scratch = m_binary ? 0 : AlignSize(keyBytes) + 4 * words + 4 * chunks;
+    m_arena.Reserve(AlignSize(output) + AlignSize(maxSignatureSize) + scratch);
+    m_out = m_arena.Allocate(output);
+    m_signature = m_arena.Allocate(maxSignatureSize);
+    m_capacity = output;
+    m_size = 0;
+    m_hash.Restart();
+
+    if (m_binary) {
+        byte header[sizeof(kBinaryMagic) + 4];
+        std::memcpy(header, kBinaryMagic, sizeof(kBinaryMagic));
+        header[4] = kBinaryVersion;
+        header[5] = kAlgorithmDsaSha256;
+        header[6] = byte(keyBytes >> 8);
+        header[7] = byte(keyBytes);
+        Write(header, sizeof(header), true);
+        byte* key = Reserve(keyBytes);
+        publicKey.Encode(key, keyBytes);
+        m_hash.Update(key, keyBytes);
+        m_hash.Final(hash);
+        return;
+    }
+
+    Write(kCertificateHeader, sizeof(kCertificateHeader) - 1, true);
+
+    // Decimal digits by repeated division of little-endian 32-bit words by
+    // 10^9, collecting nine-digit chunks from the least significant end
+    byte* raw = m_arena.Allocate(keyBytes);
+    publicKey.Encode(raw, keyBytes);
+    uint32_t* limbs = reinterpret_cast<uint32_t*>(m_arena.Allocate(4 * words));
+    for (size_t i = 0; i < words; i++) {
+        uint32_t limb = 0;
+        for (size_t b = 0; b < 4 && 4 * i + b < keyBytes; b++) {
+            limb |= uint32_t(raw[keyBytes - 1 - 4 * i - b]) << (8 * b);
+        }
+        limbs[i] = limb;
+    }
+    uint32_t* chunk = reinterpret_cast<uint32_t*>(m_arena.Allocate(4 * chunks));
+    size_t count = 0;
+    size_t used = words;
+    while (used > 0 && limbs[used - 1] == 0) used--;
+    do {
+        uint64_t remainder = 0;
+        for (size_t i = used; i-- > 0;) {
+            uint64_t current = (remainder << 32) | limbs[i];
+            limbs[i] = uint32_t(current / kDecimalChunk);
+            remainder = current % kDecimalChunk;
+        }
+        chunk[count++] = uint32_t(remainder);
+        while (used > 0 && limbs[used - 1] == 0) used--;
+    } while (used > 0);
+
+    // Most significant chunk unpadded, the rest nine digits each
+    for (size_t c = count; c-- > 0;) {
+        char text[9];
+        size_t length = 0;
+        uint32_t value = chunk[c];
+        do {
+            text[8 - length++] = char('0' + value % 10);
+            value /= 10;
+        } while (value != 0 || (c + 1 != count && length < 9));
+        Write(text + 9 - length, length, true);
+    }
+    Write(".", 1, true); // Crypto++'s decimal suffix
+    m_hash.Final(hash);
+}
+
+void CertificateStreamWriter::WriteSignature(const byte* signature, size_t size) {
+    if (m_binary) {
+        byte length[2] = {byte(size >> 8), byte(size)};
+        Write(length, sizeof(length), false);
+        Write(signature, size, false);
+        return;
+    }
+
+    Write(kSignatureDelimiter, sizeof(kSignatureDelimiter) - 1, false);
+
+    // Base64 in 72-character lines, each ending in a newline, as Base64Encoder writes it
+    size_t column = 0;
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t group = uint32_t(signature[i]) << 16;
+        if (i + 1 < size) group |= uint32_t(signature[i + 1]) << 8;
+        if (i + 2 < size) group |= signature[i + 2];
+        char quad[4] = {kBase64Alphabet[group >> 18], kBase64Alphabet[(group >> 12) & 63],
+                        i + 1 < size ? kBase64Alphabet[(group >> 6) & 63] : '=',
+                        i + 2 < size ? kBase64Alphabet[group & 63] : '='};
+        for (char c : quad) {
+            if (column == kBase64LineLength) {
+                Write("\n", 1, false);
+                column = 0;
+            }
+            Write(&c, 1, false);
+            column++;
+        }
+    }
+    if (column > 0) {
+        Write("\n", 1, false);
+    }
+}
+
+// Function to find a byte string inside a buffer; returns nullptr if it is absent
+static const byte* FindBytes(const byte* begin, const byte* end, const char* needle, size_t length) {
+    const byte* found = std::search(begin, end, needle, needle + length);
+    return found == end ? nullptr : found;
+}
+
+// Function to map a Base64 character to its value, or -1 for characters the decoder skips
+static int Base64Value(byte c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+void ReadCertificateFields(const byte* data, size_t size, CertificateArena& arena, CertificateFields& fields) {
+    if (size >= sizeof(kBinaryMagic) && std::memcmp(data, kBinaryMagic, sizeof(kBinaryMagic)) == 0) {
+        CertificateView view;
+        ParseBinaryCertificate(data, size, view);
+        fields.signedData = view.signedData;
+        fields.signedDataSize = view.signedDataSize;
+        fields.publicKey = view.publicKey;
+        fields.publicKeySize = view.publicKeySize;
+        fields.signature = view.signature;
+        fields.signatureSize = view.signatureSize;
+        return;
+    }
+
+    const byte* end = data + size;
+    const byte* delimiter = FindBytes(data, end, kSignatureDelimiter, sizeof(kSignatureDelimiter) - 1);
+    if (!delimiter) {
+        throw std::runtime_error("Invalid certificate format");
+    }
+    fields.signedData = data;
+    fields.signedDataSize = delimiter - data;
+
+    static const char kLabel[] = "Subject PublicKey:";
+    const byte* label = FindBytes(data, delimiter, kLabel, sizeof(kLabel) - 1);
+    if (!label) {
+        throw std::runtime_error("Public key label not found in the input string.");
+    }
+    const byte* digits = label + sizeof(kLabel) - 1;
+    while (digits < delimiter && !std::isdigit(*digits)) digits++;
+    if (digits == delimiter) {
+        throw std::runtime_error("Public key not found in the input string.");
+    }
+    const byte* digitsEnd = digits;
+    while (digitsEnd < delimiter && std::isdigit(*digitsEnd)) digitsEnd++;
+    const byte* rest = digitsEnd;
+    if (rest < delimiter && *rest == '.') rest++;
+    while (rest < delimiter && std::isspace(*rest)) rest++;
+    if (rest != delimiter) {
+        throw std::runtime_error("Malformed public key in certificate");
+    }
+
+    const byte* encoded = delimiter + sizeof(kSignatureDelimiter) - 1;
+    size_t digitCount = digitsEnd - digits;
+    size_t words = digitCount / 9 + 2;
+    size_t signatureBound = 3 * (end - encoded) / 4 + 3;
+    arena.Reserve(8 * words + AlignSize(signatureBound));
+
+    // Decimal digits to little-endian 32-bit words, nine digits at a time
+    uint32_t* limbs = reinterpret_cast<uint32_t*>(arena.Allocate(4 * words));
+    size_t used = 0;
+    for (const byte* p = digits; p < digitsEnd;) {
+        size_t take = p == digits && digitCount % 9 ? digitCount % 9 : 9;
+        uint32_t value = 0, scale = 1;
+        for (size_t i = 0; i < take; i++, p++) {
+            value = value * 10 + (*p - '0');
+            scale *= 10;
+        }
+        uint64_t carry = value;
+        for (size_t i = 0; i < used; i++) {
+            uint64_t current = uint64_t(limbs[i]) * scale + carry;
+            limbs[i] = uint32_t(current);
+            carry = current >> 32;
+        }
+        if (carry) limbs[used++] = uint32_t(carry);
+    }
+    byte* key = arena.Allocate(4 * words);
+    size_t keySize = 4 * used;
+    for (size_t i = 0; i < used; i++) {
+        for (size_t b = 0; b < 4; b++) {
+            key[keySize - 1 - 4 * i - b] = byte(limbs[i] >> (8 * b));
+        }
+    }
+    fields.publicKey = key;
+    fields.publicKeySize = keySize;
+
+    // Base64 signature; like Base64Decoder, anything outside the alphabet is skipped
+    byte* signature = arena.Allocate(signatureBound);
+    size_t signatureSize = 0;
+    uint32_t accumulator = 0;
+    int bits = 0;
+    for (const byte* p = encoded; p < end; p++) {
+        int value = Base64Value(*p);
+        if (value < 0) continue;
+        accumulator = (accumulator << 6) | uint32_t(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            signature[signatureSize++] = byte(accumulator >> bits);
+        }
+    }
+    fields.signature = signature;
+    fields.signatureSize = signatureSize;
+}
+
+void HashSignedData(const CertificateFields& fields, byte* hash) {
+    SHA256().CalculateDigest(hash, fields.signedData, fields.signedDataSize);
+}
@@ -0,0 +1,96 @@
+#ifndef CERTIFICATE_STREAM_H
+#define CERTIFICATE_STREAM_H
+
+#include "crypto_headers.h"
+
+// Scratch memory for building or reading one certificate. Reserve() sizes
+// it once for the whole certificate and Allocate() bumps out of that, so a
+// certificate up to 4096-bit keys lives entirely in the inline buffer and
+// a larger one costs a single heap block. Reset() recycles the memory for
+// the next certificate; a heap block is kept for reuse.
+class CertificateArena {
+public:
+    static const size_t kInlineBytes = 8192;
+
+    CertificateArena() : m_heapSize(0), m_used(0), m_capacity(kInlineBytes) {}
+
+    CertificateArena(const CertificateArena&) = delete;
+    CertificateArena& operator=(const CertificateArena&) = delete;
+
+    // Function to make room for `size` more bytes; only call between Reset() and the first Allocate()
+    void Reserve(size_t size);
+
+    // Function to take `size` bytes, aligned for 32-bit words; throws if the reservation is exceeded
+    CryptoPP::byte* Allocate(size_t size);
+
+    void Reset() { m_used = 0; }
+    size_t Used() const { return m_used; }
+    size_t Capacity() const { return m_capacity; }
+
+private:
+    CryptoPP::byte* Base() { return m_heap ? m_heap.get() : m_inline; }
+
+    alignas(8) CryptoPP::byte m_inline[kInlineBytes];
+    std::unique_ptr<CryptoPP::byte[]> m_heap;
+    size_t m_heapSize;
+    size_t m_used;
+    size_t m_capacity;
+};
+
+// Builds a text or binary certificate straight into an arena. Each field
+// is written once into the output and fed to SHA-256 as it is written, so
+// the message the CA signs falls out of building the certificate, with no
+// intermediate strings. The output is byte for byte what FormatCertificate
+// and IssueBinaryCertificate produce.
+class CertificateStreamWriter {
+public:
+    CertificateStreamWriter(CertificateArena& arena, bool binary);
+
+    // Function to write the signed fields for a public key and produce the
+    // SHA-256 message to sign; the signature may be up to maxSignatureSize bytes
+    void WriteSignedPart(const CryptoPP::Integer& publicKey, size_t maxSignatureSize, CryptoPP::byte* hash);
+
+    // Function to finish the certificate with the raw DSA signature
+    void WriteSignature(const CryptoPP::byte* signature, size_t size);
+
+    // Arena space of maxSignatureSize bytes for the signer to write into
+    CryptoPP::byte* SignatureBuffer() const { return m_signature; }
+
+    const CryptoPP::byte* Data() const { return m_out; }
+    size_t Size() const { return m_size; }
+    std::string ToString() const { return std::string(reinterpret_cast<const char*>(m_out), m_size); }
+
+private:
+    void Write(const void* data, size_t size, bool hashed);
+
+    CryptoPP::byte* Reserve(size_t size);
+
+    CertificateArena& m_arena;
+    bool m_binary;
+    CryptoPP::SHA256 m_hash;
+    CryptoPP::byte* m_out;
+    CryptoPP::byte* m_signature;
+    size_t m_size;
+    size_t m_capacity;
+};
+
+// A certificate parsed in place. The signed region always points into the
+// caller's buffer, as do the key and signature of a binary certificate;
+// a text certificate's decimal key and Base64 signature are decoded into
+// the arena. The public key is big-endian.
+struct CertificateFields {
+    const CryptoPP::byte* signedData;
+    size_t signedDataSize;
+    const CryptoPP::byte* publicKey;
+    size_t publicKeySize;
+    const CryptoPP::byte* signature;
+    size_t signatureSize;
+};
+
+// Function to parse a text or binary certificate; throws if it is malformed
+void ReadCertificateFields(const CryptoPP::byte* data, size_t size, CertificateArena& arena, CertificateFields& fields);
+
+// Function to compute the SHA-256 message the CA signed
+void HashSignedData(const CertificateFields& fields, CryptoPP::byte* hash);
+
+#endif // CERTIFICATE_STREAM_H
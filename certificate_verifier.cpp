@@ -0,0 +1,88 @@
+#include "certificate_verifier.h"
+#include "certificate.h"
+#include "certificate_stream.h"
+#include "metrics.h"
+
+using namespace CryptoPP;
+
+// Certificates claimed per trip to the shared counter
+static const size_t kCertificateChunk = 8;
+
+CertificateVerifier::CertificateVerifier(const DSA::PublicKey& caKey, unsigned int teeth) {
+    const DL_GroupParameters_DSA& params = caKey.GetGroupParameters();
+    m_p = params.GetModulus();
+    m_q = params.GetSubgroupOrder();
+
+    // u1 and u2 are reduced mod q, so q sets the exponent length of both tables
+    m_gTable.Build(params.GetSubgroupGenerator(), m_p, m_q.BitCount(), teeth);
+    m_yTable.Build(caKey.GetPublicElement(), m_p, m_q.BitCount(), teeth);
+}
+
+bool CertificateVerifier::Verify(const std::string& certificate, const ModExpContext& ctx) const {
+    DH_METRIC_TIME("dh_certificate_verify_seconds", "Time parsing and verifying one certificate");
+    // Parsed in place; the signature bytes are read straight from the buffer or arena
+    CertificateArena arena;
+    CertificateFields fields;
+    ReadCertificateFields(reinterpret_cast<const byte*>(certificate.data()), certificate.size(), arena, fields);
+
+    // Signature is r || s, each the width of q
+    size_t width = m_q.ByteCount();
+    if (fields.signatureSize != 2 * width) {
+        return false;
+    }
+    Integer r(fields.signature, width), s(fields.signature + width, width);
+    if (r.IsZero() || r >= m_q || s.IsZero() || s >= m_q) {
+        return false;
+    }
+
+    // DSA signs the SHA-1 of its input, keeping the leftmost bits of q's length
+    byte hash[SHA256::DIGESTSIZE];
+    HashSignedData(fields, hash);
+    Integer e = DsaMessageRepresentative(hash, sizeof(hash), m_q);
+
+    Integer w = s.InverseMod(m_q);
+    Integer u1 = a_times_b_mod_c(e, w, m_q);
+    Integer u2 = a_times_b_mod_c(r, w, m_q);
+    Integer v = m_gTable.DualExp(u1, m_yTable, u2, ctx) % m_q;
+    return v == r;
+}
+
+void CertificateVerifier::VerifyBatch(const std::vector<std::string>& certificates, std::vector<char>& results,
+                                      unsigned int threads, CertificateCache* cache) const {
+    results.assign(certificates.size(), 0);
+    std::atomic<size_t> next(0);
+
+    auto worker = [&] {
+        // Per-thread Montgomery context for p; the tables are shared
+        ModExpContext ctx(m_p);
+        while (true) {
+            size_t begin = next.fetch_add(kCertificateChunk);
+            if (begin >= certificates.size()) {
+                break;
+            }
+            size_t end = std::min(begin + kCertificateChunk, certificates.size());
+            for (size_t i = begin; i < end; i++) {
+                try {
+                    if (cache) {
+                        // Throws if the certificate fails verification
+                        cache->GetOrVerify(certificates[i], [&](const std::string& cert) { return Verify(cert, ctx); });
+                        results[i] = 1;
+                    } else {
+                        results[i] = Verify(certificates[i], ctx) ? 1 : 0;
+                    }
+                } catch (const std::exception&) {
+                    results[i] = 0;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < std::max(1u, threads); i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
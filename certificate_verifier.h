@@ -0,0 +1,40 @@
+#ifndef CERTIFICATE_VERIFIER_H
+#define CERTIFICATE_VERIFIER_H
+
+#include "fixed_base.h"
+#include "certificate_cache.h"
+
+// Verifies certificate signatures against one CA key, accepting exactly
+// what DSA::Verifier accepts. The message is the certificate's SHA-256
+// digest, hashed again with SHA-1 and truncated to the bit length of q, and
+// the signature is r || s. The check v = (g^u1 * y^u2 mod p) mod q == r
+// walks comb tables for g and for the CA key y together, so a
+// verification costs about one short fixed-base exponentiation instead
+// of two full ones. The tables are built once and shared read-only, so
+// any number of threads can verify at once, each with its own ModExpContext.
+class CertificateVerifier {
+public:
+    explicit CertificateVerifier(const CryptoPP::DSA::PublicKey& caKey, unsigned int teeth = 8);
+
+    // Function to verify one certificate; throws if it is malformed
+    bool Verify(const std::string& certificate, const ModExpContext& ctx) const;
+
+    // Function to verify every certificate on `threads` threads; results[i]
+    // is 1 if certificate i verified and 0 if it failed or was malformed.
+    // With a cache, certificates already in it are accepted without a
+    // signature check and newly verified ones are added.
+    void VerifyBatch(const std::vector<std::string>& certificates, std::vector<char>& results, unsigned int threads,
+                     CertificateCache* cache = nullptr) const;
+
+    const CryptoPP::Integer& GetModulus() const { return m_p; }
+    const FixedBaseTable& GeneratorTable() const { return m_gTable; }
+    const FixedBaseTable& PublicKeyTable() const { return m_yTable; }
+
+private:
+    CryptoPP::Integer m_p;
+    CryptoPP::Integer m_q;
+    FixedBaseTable m_gTable;
+    FixedBaseTable m_yTable;
+};
+
+#endif // CERTIFICATE_VERIFIER_H
@@ -0,0 +1,173 @@
+#include "dh_container.h"
+#include "certificate.h"
+
+using namespace CryptoPP;
+
+// Function to pick the record type for a legacy file: either an explicit
+// "kind:path" argument or a guess from the file name
+RecordType InputType(std::string& input) {
+    static const std::pair<const char*, RecordType> kinds[] = {
+        {"params", RecordType::Params},           {"private", RecordType::PrivateKey},
+        {"public", RecordType::PublicKey},        {"session", RecordType::SessionKey},
+        {"certificate", RecordType::Certificate},
+    };
+
+    size_t colon = input.find(':');
+    if (colon != std::string::npos) {
+        std::string kind = input.substr(0, colon);
+        for (const auto& entry : kinds) {
+            if (kind == entry.first) {
+                input = input.substr(colon + 1);
+                return entry.second;
+            }
+        }
+        throw std::runtime_error("Unknown record kind: " + kind);
+    }
+
+    std::string name = input.substr(input.find_last_of('/') + 1);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (name.find("param") != std::string::npos) return RecordType::Params;
+    if (name.find("private") != std::string::npos) return RecordType::PrivateKey;
+    if (name.find("public") != std::string::npos) return RecordType::PublicKey;
+    if (name.find("ssnk") != std::string::npos || name.find("session") != std::string::npos) return RecordType::SessionKey;
+    if (name.find("cert") != std::string::npos) return RecordType::Certificate;
+    throw std::runtime_error("Cannot tell what " + input + " holds; prefix it with params:, private:, public:, session: or certificate:");
+}
+
+// Function to copy every record of an existing container
+void CopyContainer(const MappedFile& file, ContainerWriter& writer) {
+    ContainerReader reader(file);
+    ContainerRecord record;
+    while (reader.Next(record)) {
+        writer.WriteRecord(record.type, std::string(reinterpret_cast<const char*>(record.payload), record.size));
+    }
+}
+
+// Function to convert one legacy file into a container record
+void ConvertLegacy(std::string input, ContainerWriter& writer) {
+    RecordType type = InputType(input);
+    if (type == RecordType::Params) {
+        Integer p, q, g;
+        LoadIntegersFromFile(input, p, q, g);
+        writer.WriteParams(p, q, g);
+    } else if (type == RecordType::Certificate) {
+        std::string certificate = ReadFile(input);
+        Integer publicKey;
+        std::string signature;
+        ParseCertificate(certificate, publicKey, signature);
+
+        // The signature covers the text form, so it must come back byte for byte
+        if (FormatCertificate(publicKey, signature) != certificate) {
+            throw std::runtime_error("Certificate does not round-trip: " + input);
+        }
+        writer.WriteCertificate(publicKey, signature);
+    } else if (type == RecordType::SessionKey) {
+        // sessionKeyGen writes fixed-length KDF output; only --raw files hold an integer
+        Integer key;
+        try {
+            LoadIntegerFromFile(input, key);
+        } catch (const std::runtime_error&) {
+            writer.WriteRecord(type, ReadFile(input));
+            return;
+        }
+        writer.WriteKey(type, key);
+    } else {
+        Integer key;
+        LoadIntegerFromFile(input, key);
+        writer.WriteKey(type, key);
+    }
+}
+
+// Function to print every record of a container
+void ListContainer(const std::string& filename) {
+    MappedFile file(filename);
+    ContainerReader reader(file);
+    ContainerRecord record;
+    size_t count = 0;
+    std::cout << filename << ": version " << reader.Version() << ", " << file.Size() << " bytes" << std::endl;
+    while (reader.Next(record)) {
+        std::cout << "  " << count++ << ": " << RecordTypeName(record.type) << ", " << record.size << " byte payload"
+                  << std::endl;
+    }
+}
+
+// Function to write the first record of a container back in the legacy format
+void ExportLegacy(const std::string& filename, const std::string& output) {
+    MappedFile file(filename);
+    ContainerReader reader(file);
+    ContainerRecord record;
+    if (!reader.Next(record)) {
+        throw std::runtime_error("Empty container: " + filename);
+    }
+
+    if (record.type == RecordType::Params) {
+        Integer p, q, g;
+        ReadParamsRecord(record, filename, p, q, g);
+        SaveIntegersToFile(output, p, q, g);
+    } else if (record.type == RecordType::Certificate) {
+        Integer publicKey;
+        std::string signature;
+        ReadCertificateRecord(record, filename, publicKey, signature);
+        WriteFileBytes(output, FormatCertificate(publicKey, signature));
+    } else {
+        Integer key;
+        ReadKeyRecord(record, filename, key);
+        SaveIntegerToFile(output, key);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <output> <input>..." << std::endl;
+        std::cerr << "       " << argv[0] << " --list <container>" << std::endl;
+        std::cerr << "       " << argv[0] << " --legacy <container> <output>" << std::endl;
+        return 1;
+    }
+
+    try {
+        std::string mode = argv[1];
+        if (mode == "--list") {
+            for (int i = 2; i < argc; i++) {
+                ListContainer(argv[i]);
+            }
+            return 0;
+        }
+        if (mode == "--legacy") {
+            if (argc != 4) {
+                std::cerr << "Usage: " << argv[0] << " --legacy <container> <output>" << std::endl;
+                return 1;
+            }
+            ExportLegacy(argv[2], argv[3]);
+            return 0;
+        }
+
+        // Pack every input, legacy or container, into one container
+        size_t legacyBytes = 0;
+        ContainerWriter writer(mode);
+        for (int i = 2; i < argc; i++) {
+            std::string input = argv[i];
+            MappedFile file(input.substr(input.find(':') + 1));
+            legacyBytes += file.Size();
+            if (IsContainer(file.Data(), file.Size())) {
+                CopyContainer(file, writer);
+            } else {
+                ConvertLegacy(input, writer);
+            }
+        }
+        writer.Close();
+
+        MappedFile output(mode);
+        std::cout << "Wrote " << writer.Count() << " records to " << mode << ": " << output.Size() << " bytes (inputs "
+                  << legacyBytes << " bytes)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -o test convert_store.cpp dh_container.cpp certificate.cpp certificate_stream.cpp key_store.cpp metrics.cpp -lcryptopp
+// ./test store.dhc params.bin privatekeyA.bin publicKeyA.bin Certificate-A.bin
+// ./test --list store.dhc
+// ./test --legacy publicKeyA.dhc publicKeyA.bin
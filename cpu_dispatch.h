@@ -0,0 +1,16 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+// Kernel entry points marked DH_KERNEL_CLONES are compiled once per x86-64
+// ISA level when DH_MULTIVERSION is defined, as the CMake build does, and
+// the loader binds the best clone for the running CPU. flatten pulls the
+// callees into each clone so they are compiled for that level too. Only
+// non-template functions can be cloned. Otherwise the marker is empty and
+// the code targets the baseline ISA.
+#if defined(DH_MULTIVERSION) && defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define DH_KERNEL_CLONES __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default"), flatten))
+#else
+#define DH_KERNEL_CLONES
+#endif
+
+#endif // CPU_DISPATCH_H
@@ -15,9 +15,17 @@
 #include <crypto++/files.h>      // File operations
 #include <crypto++/base64.h>     // Base64 encoding/decoding
 #include <crypto++/sha.h>        // SHA hash functions
+#include <crypto++/hmac.h>       // HMAC for HKDF session-key derivation
 #include <crypto++/filters.h>    // StringSink and StringSource
 #include <crypto++/asn.h>        // ASN.1 encoding and decoding
 #include <crypto++/md5.h>        // MD5 hash function
 #include <crypto++/hex.h>        // Hex encoding/decoding
+#include <crypto++/modarith.h>   // Montgomery representation
+#include <crypto++/drbg.h>       // Deterministic random bit generators
+#include <crypto++/nbtheory.h>   // Number theory helpers (Jacobi symbol)
+#include <crypto++/crc.h>        // CRC32 record checksums
+#include <crypto++/xed25519.h>    // X25519 key agreement
+#include <crypto++/eccrypto.h>   // ECDH over prime curves
+#include <crypto++/oids.h>       // Named curve OIDs (secp256r1)
 
 #endif // CRYPTO_HEADERS_H
@@ -0,0 +1,258 @@
+#include "dh_container.h"
+
+using namespace CryptoPP;
+
+static const char kContainerMagic[3] = {'D', 'H', 'C'};
+static const size_t kHeaderSize = sizeof(kContainerMagic) + 1;
+static const size_t kChecksumSize = CRC32::DIGESTSIZE;
+
+// Function to return a printable name for a record type
+const char* RecordTypeName(RecordType type) {
+    switch (type) {
+    case RecordType::Params:
+        return "params";
+    case RecordType::PrivateKey:
+        return "private-key";
+    case RecordType::PublicKey:
+        return "public-key";
+    case RecordType::SessionKey:
+        return "session-key";
+    case RecordType::Certificate:
+        return "certificate";
+    case RecordType::VerifiedCertificate:
+        return "verified-certificate";
+    case RecordType::CacheAuthority:
+        return "cache-authority";
+    }
+    return "unknown";
+}
+
+// Function to check whether a buffer starts with the container magic
+bool IsContainer(const byte* data, size_t size) {
+    return size >= kHeaderSize && std::memcmp(data, kContainerMagic, sizeof(kContainerMagic)) == 0;
+}
+
+// Function to append an unsigned LEB128 varint
+void AppendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(char(byte(value) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(char(value));
+}
+
+// Function to decode an unsigned LEB128 varint; returns false if it is truncated,
+// does not fit 64 bits or is not minimally encoded (a trailing zero byte)
+bool ReadVarint(const byte* data, size_t size, size_t& offset, uint64_t& value) {
+    value = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (offset == size) {
+            return false;
+        }
+        byte b = data[offset++];
+        // The tenth byte carries only bit 63
+        if (shift == 63 && (b & 0x7e)) {
+            return false;
+        }
+        value |= uint64_t(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return shift == 0 || b != 0;
+        }
+    }
+    return false;
+}
+
+// Function to append one varint-length-prefixed integer field
+void AppendIntegerField(std::string& out, const Integer& a) {
+    size_t size = a.MinEncodedSize();
+    AppendVarint(out, size);
+    size_t offset = out.size();
+    out.resize(offset + size);
+    a.Encode(reinterpret_cast<byte*>(&out[offset]), size);
+}
+
+// Function to append one varint-length-prefixed byte string field
+void AppendBytesField(std::string& out, const std::string& bytes) {
+    AppendVarint(out, bytes.size());
+    out.append(bytes);
+}
+
+ContainerWriter::ContainerWriter(const std::string& filename)
+    : m_file(filename, std::ios::binary), m_filename(filename), m_count(0) {
+    if (!m_file) {
+        throw std::runtime_error("Unable to open file for writing: " + filename);
+    }
+    m_buffer.append(kContainerMagic, sizeof(kContainerMagic));
+    m_buffer.push_back(char(kContainerVersion));
+}
+
+ContainerWriter::~ContainerWriter() {
+    if (m_file.is_open()) {
+        try {
+            Close();
+        } catch (const std::exception& e) {
+            std::cerr << "Error closing container: " << e.what() << std::endl;
+        }
+    }
+}
+
+void ContainerWriter::WriteRecord(RecordType type, const std::string& payload) {
+    size_t start = m_buffer.size();
+    m_buffer.push_back(char(type));
+    AppendVarint(m_buffer, payload.size());
+    m_buffer.append(payload);
+
+    byte checksum[kChecksumSize];
+    CRC32().CalculateDigest(checksum, reinterpret_cast<const byte*>(m_buffer.data()) + start, m_buffer.size() - start);
+    m_buffer.append(reinterpret_cast<const char*>(checksum), kChecksumSize);
+
+    m_count++;
+    if (m_buffer.size() >= kFlushThreshold) {
+        Flush();
+    }
+}
+
+void ContainerWriter::WriteParams(const Integer& p, const Integer& q, const Integer& g) {
+    m_payload.clear();
+    AppendIntegerField(m_payload, p);
+    AppendIntegerField(m_payload, q);
+    AppendIntegerField(m_payload, g);
+    WriteRecord(RecordType::Params, m_payload);
+}
+
+void ContainerWriter::WriteKey(RecordType type, const Integer& key) {
+    if (type != RecordType::PrivateKey && type != RecordType::PublicKey && type != RecordType::SessionKey) {
+        throw std::invalid_argument("Not a key record type: " + std::string(RecordTypeName(type)));
+    }
+    m_payload.assign(key.MinEncodedSize(), 0);
+    key.Encode(reinterpret_cast<byte*>(&m_payload[0]), m_payload.size());
+    WriteRecord(type, m_payload);
+}
+
+void ContainerWriter::WriteCertificate(const Integer& publicKey, const std::string& signature) {
+    m_payload.clear();
+    AppendIntegerField(m_payload, publicKey);
+    AppendBytesField(m_payload, signature);
+    WriteRecord(RecordType::Certificate, m_payload);
+}
+
+void ContainerWriter::Flush() {
+    m_file.write(m_buffer.data(), m_buffer.size());
+    if (!m_file) {
+        throw std::runtime_error("Error writing container: " + m_filename);
+    }
+    m_buffer.clear();
+}
+
+void ContainerWriter::Close() {
+    Flush();
+    m_file.close();
+    if (!m_file) {
+        throw std::runtime_error("Error writing container: " + m_filename);
+    }
+}
+
+ContainerReader::ContainerReader(const byte* data, size_t size, const std::string& name)
+    : m_data(data), m_size(size), m_offset(kHeaderSize), m_version(0), m_name(name) {
+    if (!IsContainer(data, size)) {
+        throw std::runtime_error("Not a container file: " + name);
+    }
+    m_version = data[sizeof(kContainerMagic)];
+    if (m_version == 0 || m_version > kContainerVersion) {
+        throw std::runtime_error("Unsupported container version " + std::to_string(m_version) + " in " + name);
+    }
+}
+
+bool ContainerReader::Next(ContainerRecord& record) {
+    if (m_offset == m_size) {
+        return false;
+    }
+
+    size_t start = m_offset;
+    size_t offset = m_offset + 1;
+    uint64_t length;
+    if (!ReadVarint(m_data, m_size, offset, length) || length > m_size - offset ||
+        m_size - offset - length < kChecksumSize) {
+        throw std::runtime_error("Truncated record at offset " + std::to_string(start) + " in " + m_name);
+    }
+
+    size_t end = offset + size_t(length);
+    if (!CRC32().VerifyDigest(m_data + end, m_data + start, end - start)) {
+        throw std::runtime_error("Checksum mismatch at offset " + std::to_string(start) + " in " + m_name);
+    }
+
+    record.type = RecordType(m_data[start]);
+    record.payload = m_data + offset;
+    record.size = size_t(length);
+    m_offset = end + kChecksumSize;
+    return true;
+}
+
+size_t FieldReader::NextField() {
+    uint64_t length;
+    if (!ReadVarint(m_data, m_size, m_offset, length) || length > m_size - m_offset) {
+        throw std::runtime_error("Truncated field in " + m_name);
+    }
+    size_t start = m_offset;
+    m_offset += size_t(length);
+    return start;
+}
+
+void FieldReader::ReadInteger(Integer& a) {
+    size_t start = NextField();
+    if (start == m_offset) {
+        throw std::runtime_error("Empty integer field in " + m_name);
+    }
+    a.Decode(m_data + start, m_offset - start);
+}
+
+void FieldReader::ReadBytes(std::string& bytes) {
+    size_t start = NextField();
+    bytes.assign(reinterpret_cast<const char*>(m_data + start), m_offset - start);
+}
+
+void FieldReader::ExpectEnd() const {
+    if (m_offset != m_size) {
+        throw std::runtime_error("Unexpected trailing data in record of " + m_name);
+    }
+}
+
+// Function to throw unless a record has the expected type
+static void ExpectType(const ContainerRecord& record, RecordType type, const std::string& name) {
+    if (record.type != type) {
+        throw std::runtime_error("Expected a " + std::string(RecordTypeName(type)) + " record but found " +
+                                 RecordTypeName(record.type) + " in " + name);
+    }
+}
+
+// Function to decode a params record
+void ReadParamsRecord(const ContainerRecord& record, const std::string& name, Integer& p, Integer& q, Integer& g) {
+    ExpectType(record, RecordType::Params, name);
+    FieldReader fields(record, name);
+    fields.ReadInteger(p);
+    fields.ReadInteger(q);
+    fields.ReadInteger(g);
+    fields.ExpectEnd();
+}
+
+// Function to decode a private, public or session key record
+void ReadKeyRecord(const ContainerRecord& record, const std::string& name, Integer& key) {
+    if (record.type != RecordType::PrivateKey && record.type != RecordType::PublicKey &&
+        record.type != RecordType::SessionKey) {
+        throw std::runtime_error("Expected a key record but found " + std::string(RecordTypeName(record.type)) +
+                                 " in " + name);
+    }
+    if (record.size == 0) {
+        throw std::runtime_error("Empty key record in " + name);
+    }
+    key.Decode(record.payload, record.size);
+}
+
+// Function to decode a certificate record
+void ReadCertificateRecord(const ContainerRecord& record, const std::string& name, Integer& publicKey, std::string& signature) {
+    ExpectType(record, RecordType::Certificate, name);
+    FieldReader fields(record, name);
+    fields.ReadInteger(publicKey);
+    fields.ReadBytes(signature);
+    fields.ExpectEnd();
+}
@@ -0,0 +1,150 @@
+#ifndef DH_CONTAINER_H
+#define DH_CONTAINER_H
+
+#include "key_store.h"
+
+// Versioned container for params, keys and certificates. The file starts
+// with the magic "DHC" and a version byte, followed by any number of
+// records:
+//
+//   type tag (1 byte) | payload length (varint) | payload | CRC32 (4 bytes)
+//
+// The CRC32 covers the tag, length and payload. Varints are unsigned
+// LEB128 and integers are big-endian, so the layout is the same on every
+// host. Params and certificate payloads are a sequence of
+// varint-length-prefixed fields; single-key payloads are just the
+// big-endian key, since the record length already gives its size.
+
+static const unsigned int kContainerVersion = 1;
+
+// Record types stored in a container
+enum class RecordType : CryptoPP::byte {
+    Params = 1,       // p, q, g
+    PrivateKey = 2,   // one integer
+    PublicKey = 3,    // one integer
+    SessionKey = 4,   // one integer, or fixed-length KDF output
+    Certificate = 5,  // subject public key, DSA signature bytes
+    VerifiedCertificate = 6,  // SHA-256 of a verified certificate, its public key
+    CacheAuthority = 7,       // SHA-256 of the CA public key cached certificates were verified against
+};
+
+// Function to return a printable name for a record type
+const char* RecordTypeName(RecordType type);
+
+// Function to check whether a buffer starts with the container magic
+bool IsContainer(const CryptoPP::byte* data, size_t size);
+
+// Zero-copy view of one record; payload points into the reader's buffer
+struct ContainerRecord {
+    RecordType type;
+    const CryptoPP::byte* payload;
+    size_t size;
+};
+
+// Streaming writer. Records are encoded into an internal buffer that is
+// flushed to the file in large writes, so millions of small records cost
+// a few thousand syscalls.
+class ContainerWriter {
+public:
+    explicit ContainerWriter(const std::string& filename);
+    ~ContainerWriter();
+
+    // Function to append a record with an already encoded payload
+    void WriteRecord(RecordType type, const std::string& payload);
+
+    // Function to append a params record
+    void WriteParams(const CryptoPP::Integer& p, const CryptoPP::Integer& q, const CryptoPP::Integer& g);
+
+    // Function to append a private, public or session key record
+    void WriteKey(RecordType type, const CryptoPP::Integer& key);
+
+    // Function to append a certificate record
+    void WriteCertificate(const CryptoPP::Integer& publicKey, const std::string& signature);
+
+    // Function to flush the remaining records and close the file
+    void Close();
+
+    size_t Count() const { return m_count; }
+
+    static const size_t kFlushThreshold = 1 << 20;
+
+private:
+    void Flush();
+
+    std::ofstream m_file;
+    std::string m_filename;
+    std::string m_buffer;
+    std::string m_payload;
+    size_t m_count;
+};
+
+// Streaming reader over a buffer or mapped file. Records are validated
+// (length and checksum) one at a time as Next() reaches them.
+class ContainerReader {
+public:
+    ContainerReader(const CryptoPP::byte* data, size_t size, const std::string& name);
+    explicit ContainerReader(const MappedFile& file) : ContainerReader(file.Data(), file.Size(), file.Name()) {}
+
+    // Function to move to the next record; returns false at the end of the container
+    bool Next(ContainerRecord& record);
+
+    unsigned int Version() const { return m_version; }
+
+private:
+    const CryptoPP::byte* m_data;
+    size_t m_size;
+    size_t m_offset;
+    unsigned int m_version;
+    std::string m_name;
+};
+
+// Cursor over the varint-length-prefixed fields of a record payload
+class FieldReader {
+public:
+    FieldReader(const CryptoPP::byte* data, size_t size, const std::string& name)
+        : m_data(data), m_size(size), m_offset(0), m_name(name) {}
+    FieldReader(const ContainerRecord& record, const std::string& name) : FieldReader(record.payload, record.size, name) {}
+
+    // Function to decode the next field as an integer
+    void ReadInteger(CryptoPP::Integer& a);
+
+    // Function to return the next field as raw bytes
+    void ReadBytes(std::string& bytes);
+
+    // Function to throw unless every field has been consumed
+    void ExpectEnd() const;
+
+    bool AtEnd() const { return m_offset == m_size; }
+
+private:
+    size_t NextField();
+
+    const CryptoPP::byte* m_data;
+    size_t m_size;
+    size_t m_offset;
+    std::string m_name;
+};
+
+// Function to append an unsigned LEB128 varint
+void AppendVarint(std::string& out, uint64_t value);
+
+// Function to append one varint-length-prefixed integer field
+void AppendIntegerField(std::string& out, const CryptoPP::Integer& a);
+
+// Function to append one varint-length-prefixed byte string field
+void AppendBytesField(std::string& out, const std::string& bytes);
+
+// Function to decode an unsigned LEB128 varint; returns false if it is truncated,
+// does not fit 64 bits or is not minimally encoded (a trailing zero byte)
+bool ReadVarint(const CryptoPP::byte* data, size_t size, size_t& offset, uint64_t& value);
+
+// Function to decode a params record
+void ReadParamsRecord(const ContainerRecord& record, const std::string& name, CryptoPP::Integer& p, CryptoPP::Integer& q, CryptoPP::Integer& g);
+
+// Function to decode a private, public or session key record
+void ReadKeyRecord(const ContainerRecord& record, const std::string& name, CryptoPP::Integer& key);
+
+// Function to decode a certificate record
+void ReadCertificateRecord(const ContainerRecord& record, const std::string& name, CryptoPP::Integer& publicKey, std::string& signature);
+
+#endif // DH_CONTAINER_H
@@ -0,0 +1,248 @@
+#include "dh_protocol.h"
+#include "certificate.h"
+#include "certificate_verifier.h"
+#include "certificate_signer.h"
+#include "named_groups.h"
+#include "secret_exp.h"
+#include "metrics.h"
+
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace CryptoPP;
+
+// Peer certificates remembered after their first successful verification
+static const size_t kCacheCapacity = 1 << 16;
+
+// Everything loaded once at startup and shared by every connection; only
+// the certificate cache changes after startup, and it locks internally
+struct DaemonState {
+    DaemonState() : cache(kCacheCapacity) {}
+
+    Integer p, q, g;
+    size_t exponentBits;
+    FixedBaseTable table;
+    DSA::PrivateKey caPrivateKey;
+    DSA::PublicKey caPublicKey;
+    std::unique_ptr<CertificateVerifier> verifier;
+    std::unique_ptr<SigningEngine> signer;
+    CertificateCache cache;
+};
+
+static volatile std::sig_atomic_t g_stop = 0;
+
+// Function to stop the accept loop on SIGINT or SIGTERM
+void HandleStopSignal(int) {
+    g_stop = 1;
+}
+
+// Per-connection scratch: modulus contexts for the DH group (variable-time
+// for public exponents, constant-time for private keys) and the CA's DSA
+// group and an RNG seeded once per connection
+struct Session {
+    explicit Session(DaemonState& state)
+        : state(state), ctx(state.p), secretCtx(state.p), caCtx(state.verifier->GetModulus()), upperBound(state.p - 1) {}
+
+    // Function to get a certificate's public key, verifying it only if it is not cached
+    Integer VerifiedPublicKey(const std::string& certificate) {
+        return state.cache.GetOrVerify(certificate, [this](const std::string& cert) {
+            return state.verifier->Verify(cert, caCtx);
+        });
+    }
+
+    DaemonState& state;
+    ModExpContext ctx;
+    SecretExpContext secretCtx; // constant-time, for private keys
+    ModExpContext caCtx;
+    AutoSeededRandomPool rng;
+    Integer upperBound;
+};
+
+// Function to reject public keys 0, 1 and p-1, which would pin the shared secret
+void CheckPublicKey(const Integer& key, const Session& session) {
+    if (key <= Integer::One() || key >= session.upperBound) {
+        throw std::runtime_error("Public key out of range");
+    }
+}
+
+// Function to serve one request and build its response fields
+void HandleRequest(Session& session, const std::string& request, std::string& response) {
+    Opcode op = Opcode(byte(request[0]));
+    FieldReader fields(reinterpret_cast<const byte*>(request.data()) + 1, request.size() - 1, "request");
+
+    if (op == Opcode::Ping) {
+        fields.ExpectEnd();
+    } else if (op == Opcode::KeyGen) {
+        DH_METRIC_TIME("dh_daemon_keygen_seconds", "Time serving KeyGen requests");
+        fields.ExpectEnd();
+        // Private key drawn as privateKeyGen draws it; public key from the g table
+        Integer privateKey = RandomPrivateExponent(session.rng, session.state.q, session.state.exponentBits);
+        AppendIntegerField(response, privateKey);
+        AppendIntegerField(response, session.state.table.Exp(privateKey, session.ctx));
+    } else if (op == Opcode::IssueCertificate) {
+        DH_METRIC_TIME("dh_daemon_issue_seconds", "Time serving IssueCertificate requests");
+        Integer publicKey;
+        fields.ReadInteger(publicKey);
+        fields.ExpectEnd();
+        CheckPublicKey(publicKey, session);
+        AppendBytesField(response, session.state.signer->Issue(publicKey, false, session.caCtx, session.rng));
+    } else if (op == Opcode::VerifyCertificate) {
+        DH_METRIC_TIME("dh_daemon_verify_seconds", "Time serving VerifyCertificate requests");
+        std::string certificate;
+        fields.ReadBytes(certificate);
+        fields.ExpectEnd();
+        Integer publicKey;
+        bool valid = true;
+        try {
+            publicKey = session.VerifiedPublicKey(certificate);
+        } catch (const std::exception&) {
+            // Report the subject key of a certificate that fails verification
+            publicKey = CertificatePublicKey(certificate);
+            valid = false;
+        }
+        AppendBytesField(response, valid ? "\x01" : std::string(1, '\0'));
+        AppendIntegerField(response, publicKey);
+    } else if (op == Opcode::SessionKey) {
+        DH_METRIC_TIME("dh_daemon_session_key_seconds", "Time serving SessionKey requests");
+        std::string certificate;
+        Integer privateKey;
+        fields.ReadBytes(certificate);
+        fields.ReadInteger(privateKey);
+        fields.ExpectEnd();
+        // Only CA-signed peer keys; repeat peers hit the cache and skip parsing
+        Integer peerKey = session.VerifiedPublicKey(certificate);
+        CheckPublicKey(peerKey, session);
+        AppendIntegerField(response, session.secretCtx.Exp(peerKey, privateKey, session.state.exponentBits));
+    } else if (op == Opcode::Metrics) {
+        fields.ExpectEnd();
+        std::ostringstream text;
+        WriteMetricsPrometheus(text);
+        AppendBytesField(response, text.str());
+    } else {
+        throw std::runtime_error("Unknown opcode " + std::to_string(int(op)));
+    }
+}
+
+// Function to serve requests on one connection until the client disconnects
+void ServeConnection(int fd, DaemonState& state) {
+    try {
+        Session session(state);
+        std::string request, response;
+        while (ReadFrame(fd, request)) {
+            response.assign(1, char(kStatusOk));
+            try {
+                HandleRequest(session, request, response);
+            } catch (const std::exception& e) {
+                DH_METRIC_COUNT("dh_daemon_request_errors_total", "Requests answered with an error", 1);
+                response.assign(1, char(kStatusError));
+                AppendBytesField(response, e.what());
+            }
+            WriteFrame(fd, response);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Connection closed: " << e.what() << std::endl;
+    }
+    close(fd);
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int teeth = 8;
+    // Precomputed signing nonces for IssueCertificate; depth 0 signs inline
+    NoncePoolConfig poolConfig;
+    poolConfig.depth = 256;
+    bool validArgs = argc <= 6;
+    if (validArgs) {
+        // A malformed number prints the usage rather than escaping main()
+        try {
+            if (argc > 2) {
+                teeth = std::stoul(argv[2]);
+            }
+            if (argc > 3) {
+                poolConfig.depth = std::stoul(argv[3]);
+            }
+            if (argc > 4) {
+                poolConfig.refillRate = std::stod(argv[4]);
+            }
+        } catch (const std::logic_error&) {
+            validArgs = false;
+        }
+    }
+    if (!validArgs) {
+        std::cerr << "Usage: " << argv[0] << " [socket_path] [teeth] [nonce_pool_depth] [nonce_refill_rate] [params_file|group]" << std::endl;
+        return 1;
+    }
+    std::string socketPath = argc > 1 ? argv[1] : "dh_daemon.sock";
+    // A named group such as ffdhe2048 replaces params.bin
+    std::string groupSource = argc > 5 ? argv[5] : "params.bin";
+
+    try {
+        // Load everything the per-step tools would reload on every run. The
+        // state is never freed so detached connection threads can't outlive it.
+        DaemonState& state = *new DaemonState;
+        LoadGroupParameters(groupSource, state.p, state.q, state.g, state.exponentBits);
+        LoadDSAPrivateKey("CA_Priv.bin", state.caPrivateKey);
+        LoadDSAPublicKey("CA_Pub.bin", state.caPublicKey);
+        state.verifier.reset(new CertificateVerifier(state.caPublicKey));
+        state.signer.reset(new SigningEngine(state.caPrivateKey, poolConfig));
+        bool built = LoadOrBuildFixedBaseTable(state.table, FixedBaseTableFile(groupSource), state.g, state.p,
+                                               state.exponentBits, teeth);
+        std::cout << (built ? "Built" : "Loaded") << " fixed-base table: " << state.table.Entries() << " entries"
+                  << std::endl;
+
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("Socket path too long: " + socketPath);
+        }
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+        int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0) {
+            throw std::runtime_error("Unable to create socket");
+        }
+        unlink(socketPath.c_str()); // Remove a stale socket from an earlier run
+        if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listener, 64) != 0) {
+            close(listener);
+            throw std::runtime_error("Unable to listen on " + socketPath);
+        }
+
+        // No SA_RESTART, so a signal interrupts accept() and ends the loop
+        struct sigaction action = {};
+        action.sa_handler = HandleStopSignal;
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+
+        std::cout << "Listening on " << socketPath << std::endl;
+        while (!g_stop) {
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("accept failed");
+            }
+            DH_METRIC_COUNT("dh_daemon_connections_total", "Connections accepted", 1);
+            std::thread(ServeConnection, fd, std::ref(state)).detach();
+        }
+
+        close(listener);
+        unlink(socketPath.c_str());
+        CertificateCacheStats stats = state.cache.Stats();
+        SigningStats signing = state.signer->Stats();
+        std::cout << "Stopped; certificate cache " << stats.hits << " hits, " << stats.misses << " misses, "
+                  << stats.entries << " entries; " << signing.pooled << " pooled and " << signing.inlined
+                  << " inline signing nonces" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test dh_daemon.cpp dh_protocol.cpp certificate.cpp certificate_stream.cpp certificate_signer.cpp certificate_verifier.cpp certificate_cache.cpp named_groups.cpp fixed_base.cpp secret_exp.cpp mod_exp.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp -lpthread
+// ./test dh_daemon.sock 8 256
+// ./test dh_daemon.sock 8 256 0 ffdhe2048
@@ -0,0 +1,159 @@
+#include "handshake.h"
+#include "certificate.h"
+#include "prime_search.h"
+
+using namespace CryptoPP;
+
+// Function to return the value at a percentile of a sorted sample, by the
+// nearest-rank method bench_suite uses
+double Percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = size_t(std::ceil(fraction * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+// Function to run the setup phase in memory: a fresh p with a 256-bit q,
+// a generator and a CA key in the same group
+void FreshSetup(size_t bits, Integer& p, Integer& q, Integer& g, DSA::PrivateKey& caKey) {
+    PrimeSearchOptions search;
+    search.threads = std::max(1u, std::thread::hardware_concurrency());
+    q = GeneratePrime(256, search);
+    p = GeneratePrimeWithCondition(bits, q, search);
+    for (Integer h = 2;; ++h) {
+        g = ModExp(h, (p - 1) / q, p);
+        if (g != Integer::One()) {
+            break;
+        }
+    }
+
+    AutoSeededRandomPool rng;
+    DL_GroupParameters_DSA params;
+    params.Initialize(p, q, g);
+    Integer caSecret;
+    caSecret.Randomize(rng, 1, q - 1);
+    caKey.Initialize(params, caSecret);
+}
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [handshakes] [threads] [--group <group>] [--params <params_file>]"
+              << " [--ca <ca_priv_key_file>] [--fresh <bits>] [--pool <depth>] [--kdf <label>[:<bytes>]]... [--text]"
+              << std::endl;
+    std::cerr << "Groups:";
+    for (const std::string& name : KeyAgreementBackendNames()) {
+        std::cerr << ' ' << name;
+    }
+    std::cerr << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    HandshakeConfig config;
+    std::string caKeyFile = "CA_Priv.bin";
+    std::string freshArg, poolArg;
+    std::vector<std::string> kdfSpecs;
+    std::vector<std::string> args;
+    bool validArgs = true;
+    for (int i = 1; validArgs && i < argc; i++) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--group" && hasValue) {
+            config.group = argv[++i];
+        } else if (option == "--params" && hasValue) {
+            config.paramsFile = argv[++i];
+        } else if (option == "--ca" && hasValue) {
+            caKeyFile = argv[++i];
+        } else if (option == "--fresh" && hasValue) {
+            freshArg = argv[++i];
+        } else if (option == "--pool" && hasValue) {
+            poolArg = argv[++i];
+        } else if (option == "--kdf" && hasValue) {
+            kdfSpecs.push_back(argv[++i]);
+        } else if (option == "--text") {
+            config.binaryCertificates = false;
+        } else if (option.compare(0, 2, "--") != 0 && args.size() < 2) {
+            args.push_back(option);
+        } else {
+            validArgs = false;
+        }
+    }
+
+    // Numbers are parsed here so a malformed one prints the usage, not an
+    // uncaught exception; at least one thread runs, as in RunHandshakes
+    size_t freshBits = 0;
+    unsigned long long handshakes = 1000;
+    unsigned int threads = 1;
+    try {
+        if (!freshArg.empty()) {
+            freshBits = std::stoul(freshArg);
+        }
+        if (!poolArg.empty()) {
+            config.nonces.depth = std::stoul(poolArg);
+        }
+        if (args.size() > 0) {
+            handshakes = std::stoull(args[0]);
+        }
+        if (args.size() > 1) {
+            threads = unsigned(std::max<unsigned long>(1, std::stoul(args[1])));
+        }
+    } catch (const std::logic_error&) {
+        validArgs = false;
+    }
+    if (!validArgs || (freshBits != 0 && config.group != "modp")) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        if (!kdfSpecs.empty()) {
+            config.kdf.clear();
+            for (const std::string& spec : kdfSpecs) {
+                config.kdf.push_back(ParseKdfOutput(spec));
+            }
+        }
+
+        // Setup once: everything the exchanges share, timed apart from them
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<HandshakeContext> context;
+        if (freshBits != 0) {
+            Integer p, q, g;
+            DSA::PrivateKey caKey;
+            FreshSetup(freshBits, p, q, g, caKey);
+            context.reset(new HandshakeContext(caKey, p, q, g, config));
+        } else {
+            DSA::PrivateKey caKey;
+            LoadDSAPrivateKey(caKeyFile, caKey);
+            context.reset(new HandshakeContext(caKey, config));
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::unique_ptr<KeyAgreementBackend> group = context->MakeBackend();
+        std::cout << "group " << group->Name() << ", " << group->PublicKeyLength() * 8 << "-bit public keys, "
+                  << (config.binaryCertificates ? "binary" : "text") << " certificates, setup "
+                  << std::fixed << std::setprecision(3) << std::chrono::duration<double>(end - start).count() << " s"
+                  << std::endl;
+
+        HandshakeStats stats = RunHandshakes(*context, handshakes, threads);
+        std::sort(stats.latencies.begin(), stats.latencies.end());
+        std::cout << stats.completed << " handshakes over " << threads << " threads in " << stats.seconds << " s"
+                  << std::endl;
+        std::cout << std::setprecision(1) << "  p50 " << Percentile(stats.latencies, 0.50) << " us, p99 "
+                  << Percentile(stats.latencies, 0.99) << " us, max "
+                  << (stats.latencies.empty() ? 0.0 : stats.latencies.back()) << " us, "
+                  << stats.HandshakesPerSecond() << " handshakes/s" << std::endl;
+        if (stats.mismatched != 0) {
+            std::cerr << "Error: " << stats.mismatched << " handshakes derived different session keys" << std::endl;
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test dh_handshake.cpp handshake.cpp session_kdf.cpp key_agreement.cpp named_groups.cpp prime_search.cpp primality.cpp certificate.cpp certificate_stream.cpp certificate_signer.cpp certificate_verifier.cpp certificate_cache.cpp fixed_base.cpp secret_exp.cpp mod_exp.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp -lpthread
+// ./test 10000 4
+// ./test 1000 8 --group x25519
+// ./test 1000 4 --fresh 2048
+// ./test 1000 4 --kdf client_write:32 --kdf server_write:32 --kdf iv:12
@@ -0,0 +1,123 @@
+#include "dh_protocol.h"
+
+using namespace CryptoPP;
+
+// Function to return the value at a percentile of a sorted sample
+double Percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = std::min(sorted.size() - 1, size_t(fraction * sorted.size()));
+    return sorted[index];
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argc > 5) {
+        std::cerr << "Usage: " << argv[0] << " <socket_path> <ping|keygen|issue|verify|session|metrics> [requests] [connections]"
+                  << std::endl;
+        return 1;
+    }
+    std::string socketPath = argv[1];
+    std::string operation = argv[2];
+    size_t requests = argc > 3 ? std::stoul(argv[3]) : 1000;
+    unsigned int connections = argc > 4 ? std::stoul(argv[4]) : 1;
+    if (connections == 0) {
+        connections = 1;
+    }
+
+    try {
+        // Print what the daemon has recorded so far instead of loading it
+        if (operation == "metrics") {
+            DaemonClient client(socketPath);
+            std::cout << client.Metrics();
+            return 0;
+        }
+
+        // One key pair and certificate to feed the issue/verify/session requests
+        DaemonClient setup(socketPath);
+        Integer privateKey, publicKey, peerPrivateKey, peerPublicKey;
+        setup.KeyGen(privateKey, publicKey);
+        setup.KeyGen(peerPrivateKey, peerPublicKey);
+        std::string peerCertificate = setup.IssueCertificate(peerPublicKey);
+
+        std::function<void(DaemonClient&)> request;
+        if (operation == "ping") {
+            request = [](DaemonClient& client) { client.Ping(); };
+        } else if (operation == "keygen") {
+            request = [](DaemonClient& client) {
+                Integer x, y;
+                client.KeyGen(x, y);
+            };
+        } else if (operation == "issue") {
+            request = [&](DaemonClient& client) { client.IssueCertificate(publicKey); };
+        } else if (operation == "verify") {
+            request = [&](DaemonClient& client) {
+                Integer subject;
+                if (!client.VerifyCertificate(peerCertificate, subject)) {
+                    throw std::runtime_error("Daemon rejected its own certificate");
+                }
+            };
+        } else if (operation == "session") {
+            request = [&](DaemonClient& client) { client.SessionKey(peerCertificate, privateKey); };
+        } else {
+            std::cerr << "Unknown operation: " << operation << std::endl;
+            return 1;
+        }
+
+        // Each connection issues its share of requests back to back and
+        // records the round-trip time of every one
+        std::vector<std::vector<double>> latencies(connections);
+        std::vector<std::string> errors(connections);
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int c = 0; c < connections; c++) {
+            size_t count = requests / connections + (c < requests % connections ? 1 : 0);
+            workers.emplace_back([&, c, count] {
+                try {
+                    DaemonClient client(socketPath);
+                    latencies[c].reserve(count);
+                    for (size_t i = 0; i < count; i++) {
+                        auto begin = std::chrono::steady_clock::now();
+                        request(client);
+                        auto end = std::chrono::steady_clock::now();
+                        latencies[c].push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+                    }
+                } catch (const std::exception& e) {
+                    errors[c] = e.what();
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        for (const std::string& error : errors) {
+            if (!error.empty()) {
+                throw std::runtime_error(error);
+            }
+        }
+
+        std::vector<double> all;
+        for (const std::vector<double>& sample : latencies) {
+            all.insert(all.end(), sample.begin(), sample.end());
+        }
+        std::sort(all.begin(), all.end());
+        double seconds = std::chrono::duration<double>(end - start).count();
+
+        std::cout << operation << ": " << all.size() << " requests over " << connections << " connections in "
+                  << std::fixed << std::setprecision(3) << seconds << " s" << std::endl;
+        std::cout << std::setprecision(1) << "  p50 " << Percentile(all, 0.50) << " us, p99 " << Percentile(all, 0.99)
+                  << " us, max " << (all.empty() ? 0.0 : all.back()) << " us, "
+                  << (seconds > 0 ? all.size() / seconds : 0.0) << " requests/s" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test dh_loadgen.cpp dh_protocol.cpp dh_container.cpp key_store.cpp metrics.cpp -lcryptopp -lpthread
+// ./test dh_daemon.sock session 10000 4
+// ./test dh_daemon.sock metrics
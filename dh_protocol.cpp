@@ -0,0 +1,167 @@
+#include "dh_protocol.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace CryptoPP;
+
+// Function to read exactly size bytes; returns false on end of stream before the first byte
+static bool ReadExactly(int fd, char* data, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = read(fd, data + done, size - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            if (n == 0 && done == 0) {
+                return false;
+            }
+            throw std::runtime_error("Connection lost while reading a frame");
+        }
+        done += size_t(n);
+    }
+    return true;
+}
+
+// Function to read one frame; returns false if the peer closed the connection between frames
+bool ReadFrame(int fd, std::string& payload) {
+    byte header[4];
+    if (!ReadExactly(fd, reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+    size_t size = (size_t(header[0]) << 24) | (size_t(header[1]) << 16) | (size_t(header[2]) << 8) | header[3];
+    if (size == 0 || size > kMaxFrameBytes) {
+        throw std::runtime_error("Invalid frame length " + std::to_string(size));
+    }
+    payload.resize(size);
+    if (!ReadExactly(fd, &payload[0], size)) {
+        throw std::runtime_error("Connection lost while reading a frame");
+    }
+    return true;
+}
+
+// Function to write one frame
+void WriteFrame(int fd, const std::string& payload) {
+    if (payload.size() > kMaxFrameBytes) {
+        throw std::runtime_error("Frame too large: " + std::to_string(payload.size()) + " bytes");
+    }
+
+    // Header and payload go out in one send so a small message is one packet
+    std::string frame(4, 0);
+    frame[0] = char(payload.size() >> 24);
+    frame[1] = char(payload.size() >> 16);
+    frame[2] = char(payload.size() >> 8);
+    frame[3] = char(payload.size());
+    frame.append(payload);
+
+    size_t done = 0;
+    while (done < frame.size()) {
+        ssize_t n = send(fd, frame.data() + done, frame.size() - done, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error("Connection lost while writing a frame");
+        }
+        done += size_t(n);
+    }
+}
+
+DaemonClient::DaemonClient(const std::string& socketPath) : m_fd(-1) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_fd < 0) {
+        throw std::runtime_error("Unable to create socket");
+    }
+    if (connect(m_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(m_fd);
+        throw std::runtime_error("Unable to connect to " + socketPath);
+    }
+}
+
+DaemonClient::~DaemonClient() {
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+void DaemonClient::Call(Opcode op, const std::string& fields, std::string& response) {
+    m_request.assign(1, char(op));
+    m_request.append(fields);
+    WriteFrame(m_fd, m_request);
+    if (!ReadFrame(m_fd, m_response)) {
+        throw std::runtime_error("Daemon closed the connection");
+    }
+
+    if (byte(m_response[0]) != kStatusOk) {
+        std::string message;
+        FieldReader reader(reinterpret_cast<const byte*>(m_response.data()) + 1, m_response.size() - 1, "response");
+        reader.ReadBytes(message);
+        throw std::runtime_error(message);
+    }
+    response.assign(m_response, 1, std::string::npos);
+}
+
+void DaemonClient::Ping() {
+    std::string response;
+    Call(Opcode::Ping, std::string(), response);
+}
+
+void DaemonClient::KeyGen(Integer& privateKey, Integer& publicKey) {
+    std::string response;
+    Call(Opcode::KeyGen, std::string(), response);
+    FieldReader reader(reinterpret_cast<const byte*>(response.data()), response.size(), "KeyGen response");
+    reader.ReadInteger(privateKey);
+    reader.ReadInteger(publicKey);
+    reader.ExpectEnd();
+}
+
+std::string DaemonClient::IssueCertificate(const Integer& publicKey) {
+    std::string fields, response, certificate;
+    AppendIntegerField(fields, publicKey);
+    Call(Opcode::IssueCertificate, fields, response);
+    FieldReader reader(reinterpret_cast<const byte*>(response.data()), response.size(), "IssueCertificate response");
+    reader.ReadBytes(certificate);
+    reader.ExpectEnd();
+    return certificate;
+}
+
+bool DaemonClient::VerifyCertificate(const std::string& certificate, Integer& publicKey) {
+    std::string fields, response, valid;
+    AppendBytesField(fields, certificate);
+    Call(Opcode::VerifyCertificate, fields, response);
+    FieldReader reader(reinterpret_cast<const byte*>(response.data()), response.size(), "VerifyCertificate response");
+    reader.ReadBytes(valid);
+    reader.ReadInteger(publicKey);
+    reader.ExpectEnd();
+    return valid == "\x01";
+}
+
+Integer DaemonClient::SessionKey(const std::string& certificate, const Integer& privateKey) {
+    std::string fields, response;
+    AppendBytesField(fields, certificate);
+    AppendIntegerField(fields, privateKey);
+    Call(Opcode::SessionKey, fields, response);
+    FieldReader reader(reinterpret_cast<const byte*>(response.data()), response.size(), "SessionKey response");
+    Integer sessionKey;
+    reader.ReadInteger(sessionKey);
+    reader.ExpectEnd();
+    return sessionKey;
+}
+
+std::string DaemonClient::Metrics() {
+    std::string response, text;
+    Call(Opcode::Metrics, std::string(), response);
+    FieldReader reader(reinterpret_cast<const byte*>(response.data()), response.size(), "Metrics response");
+    reader.ReadBytes(text);
+    reader.ExpectEnd();
+    return text;
+}
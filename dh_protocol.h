@@ -0,0 +1,72 @@
+#ifndef DH_PROTOCOL_H
+#define DH_PROTOCOL_H
+
+#include "dh_container.h"
+
+// Framed request/response protocol spoken by dh_daemon over a Unix domain
+// socket. Every message is a 4-byte big-endian length followed by that
+// many payload bytes. A request payload is an opcode byte followed by
+// varint-length-prefixed fields (the same field encoding as dh_container);
+// a response payload is a status byte followed by the result fields, or
+// by a single error-message field when the status is kStatusError.
+//
+//   Ping               ->  (nothing)
+//   KeyGen             ->  private key, public key
+//   IssueCertificate   public key -> certificate text
+//   VerifyCertificate  certificate text -> valid (1 byte), subject public key
+//   SessionKey         certificate text, private key -> session key
+//   Metrics            ->  Prometheus text of the daemon's metrics
+//
+// Certificates are checked against the CA key once and then served from
+// the daemon's verified-certificate cache; SessionKey rejects a peer
+// certificate that does not verify.
+
+enum class Opcode : CryptoPP::byte {
+    Ping = 0,
+    KeyGen = 1,
+    IssueCertificate = 2,
+    VerifyCertificate = 3,
+    SessionKey = 4,
+    Metrics = 5,
+};
+
+static const CryptoPP::byte kStatusOk = 0;
+static const CryptoPP::byte kStatusError = 1;
+
+// Largest payload either side accepts
+static const size_t kMaxFrameBytes = 1 << 20;
+
+// Function to read one frame; returns false if the peer closed the connection between frames
+bool ReadFrame(int fd, std::string& payload);
+
+// Function to write one frame
+void WriteFrame(int fd, const std::string& payload);
+
+// Blocking client for one connection to the daemon. Each call sends one
+// request and waits for its response; server-side failures are thrown as
+// std::runtime_error with the daemon's message.
+class DaemonClient {
+public:
+    explicit DaemonClient(const std::string& socketPath);
+    ~DaemonClient();
+
+    DaemonClient(const DaemonClient&) = delete;
+    DaemonClient& operator=(const DaemonClient&) = delete;
+
+    // Function to send a request and return the response fields
+    void Call(Opcode op, const std::string& fields, std::string& response);
+
+    void Ping();
+    void KeyGen(CryptoPP::Integer& privateKey, CryptoPP::Integer& publicKey);
+    std::string IssueCertificate(const CryptoPP::Integer& publicKey);
+    bool VerifyCertificate(const std::string& certificate, CryptoPP::Integer& publicKey);
+    CryptoPP::Integer SessionKey(const std::string& certificate, const CryptoPP::Integer& privateKey);
+    std::string Metrics();
+
+private:
+    int m_fd;
+    std::string m_request;
+    std::string m_response;
+};
+
+#endif // DH_PROTOCOL_H
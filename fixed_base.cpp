@@ -0,0 +1,328 @@
+#include "fixed_base.h"
+#include "fixed_bignum.h"
+#include "secret_exp.h"
+#include "key_store.h"
+#include "metrics.h"
+
+using namespace CryptoPP;
+
+static const char kTableMagic[8] = {'D', 'H', 'C', 'O', 'M', 'B', '0', '1'};
+
+// Fixed-width copy of a comb table, one instantiation per limb count like
+// SecretExpEngine, used when the modulus fits FixedMontgomery
+class FixedCombEngine {
+public:
+    virtual ~FixedCombEngine() {}
+    virtual Integer Exp(const Integer& exponent, unsigned int teeth, size_t spacing) const = 0;
+};
+
+// Function to walk the comb on fixed-width values: every column squares,
+// scans the whole table and multiplies, so time and memory access depend
+// only on the table shape. A plain overload per limb count so each can be
+// cloned per ISA level.
+#define FIXED_COMB_KERNEL(L)                                                                                     \
+    DH_KERNEL_CLONES static void FixedComb(const FixedMontgomery<L>& montgomery, const FixedUInt<L>* table,       \
+                                           size_t entries, unsigned int teeth, size_t spacing,                    \
+                                           const FixedUInt<L>& exponent, FixedUInt<L>& r) {                       \
+        FixedUInt<L> acc = montgomery.One(), selected;                                                            \
+        for (size_t col = spacing; col-- > 0;) {                                                                  \
+            montgomery.Multiply(acc, acc, acc);                                                                   \
+            uint64_t index = 0;                                                                                   \
+            for (unsigned int j = 0; j < teeth; j++) {                                                            \
+                size_t bit = j * spacing + col;                                                                   \
+                index |= uint64_t(bit < FixedUInt<L>::kBits ? exponent.Bit(bit) : 0) << j;                        \
+            }                                                                                                     \
+            FixedMontgomery<L>::Select(selected, table, entries, index);                                          \
+            montgomery.Multiply(acc, acc, selected);                                                              \
+        }                                                                                                         \
+        montgomery.ConvertOut(r, acc);                                                                            \
+    }
+FIXED_COMB_KERNEL(16)
+FIXED_COMB_KERNEL(32)
+FIXED_COMB_KERNEL(48)
+FIXED_COMB_KERNEL(64)
+#undef FIXED_COMB_KERNEL
+
+template <size_t L>
+class FixedCombEngineT : public FixedCombEngine {
+public:
+    // Function to copy a table given in standard form into Montgomery form
+    FixedCombEngineT(const Integer& modulus, const std::vector<Integer>& entries)
+        : m_montgomery(modulus), m_table(entries.size()) {
+        for (size_t i = 0; i < entries.size(); i++) {
+            FixedUInt<L> value;
+            value.FromInteger(entries[i]);
+            m_montgomery.ConvertIn(m_table[i], value);
+        }
+    }
+
+    Integer Exp(const Integer& exponent, unsigned int teeth, size_t spacing) const override {
+        FixedUInt<L> e, r;
+        e.FromInteger(exponent);
+        FixedComb(m_montgomery, m_table.data(), m_table.size(), teeth, spacing, e, r);
+        return r.ToInteger();
+    }
+
+private:
+    FixedMontgomery<L> m_montgomery;
+    std::vector<FixedUInt<L>> m_table;
+};
+
+FixedBaseTable::FixedBaseTable() : m_exponentBits(0), m_teeth(0), m_spacing(0), m_entryWords(0) {}
+
+FixedBaseTable::~FixedBaseTable() {}
+
+void FixedBaseTable::Initialize(const Integer& base, const Integer& modulus, size_t exponentBits, unsigned int teeth) {
+    if (teeth == 0 || teeth > 16) {
+        throw InvalidArgument("FixedBaseTable: teeth must be between 1 and 16");
+    }
+    if (exponentBits == 0) {
+        throw InvalidArgument("FixedBaseTable: exponent length must be positive");
+    }
+
+    m_base = base % modulus;
+    m_modulus = modulus;
+    m_exponentBits = exponentBits;
+    m_teeth = teeth;
+    m_spacing = (exponentBits + teeth - 1) / teeth;
+    m_ctx.reset(new ModExpContext(modulus));
+    m_table.assign(size_t(1) << teeth, Integer());
+    m_fixed.reset();
+    m_words.clear();
+}
+
+void FixedBaseTable::Build(const Integer& base, const Integer& modulus, size_t exponentBits, unsigned int teeth) {
+    DH_METRIC_TIME("dh_fixed_base_build_seconds", "Time building comb tables");
+    Initialize(base, modulus, exponentBits, teeth);
+
+    // rowBase[j] = base^(2^(j * spacing)) in Montgomery form
+    std::vector<Integer> rowBase(teeth);
+    rowBase[0] = m_ctx->ConvertIn(m_base);
+    for (unsigned int j = 1; j < teeth; j++) {
+        rowBase[j] = rowBase[j - 1];
+        for (size_t k = 0; k < m_spacing; k++) {
+            rowBase[j] = m_ctx->Square(rowBase[j]);
+        }
+    }
+
+    // table[i] = product of rowBase[j] over the set bits j of i
+    m_table[0] = m_ctx->One();
+    for (size_t i = 1; i < m_table.size(); i++) {
+        unsigned int top = 0;
+        while ((i >> (top + 1)) != 0) top++;
+        size_t rest = i ^ (size_t(1) << top);
+        m_table[i] = rest == 0 ? rowBase[top] : m_ctx->Multiply(m_table[rest], rowBase[top]);
+    }
+    PrepareSecretPath();
+}
+
+void FixedBaseTable::PrepareSecretPath() {
+    std::vector<Integer> entries(m_table.size());
+    for (size_t i = 0; i < m_table.size(); i++) {
+        entries[i] = m_ctx->ConvertOut(m_table[i]);
+    }
+    switch (FixedWidthLimbs(m_modulus)) {
+    case 16: m_fixed.reset(new FixedCombEngineT<16>(m_modulus, entries)); return;
+    case 32: m_fixed.reset(new FixedCombEngineT<32>(m_modulus, entries)); return;
+    case 48: m_fixed.reset(new FixedCombEngineT<48>(m_modulus, entries)); return;
+    case 64: m_fixed.reset(new FixedCombEngineT<64>(m_modulus, entries)); return;
+    }
+
+    // Other moduli keep the Integer entries packed for masked selection;
+    // each entry is stored big-endian in m_entryWords 64-bit words
+    m_entryWords = (m_modulus.ByteCount() + 7) / 8;
+    m_words.assign(m_table.size() * m_entryWords, 0);
+    std::vector<byte> bytes(8 * m_entryWords);
+    for (size_t i = 0; i < m_table.size(); i++) {
+        m_table[i].Encode(bytes.data(), bytes.size());
+        for (size_t w = 0; w < m_entryWords; w++) {
+            uint64_t word = 0;
+            for (size_t b = 0; b < 8; b++) {
+                word = (word << 8) | bytes[8 * w + b];
+            }
+            m_words[i * m_entryWords + w] = word;
+        }
+    }
+}
+
+Integer FixedBaseTable::SelectEntry(size_t index, uint64_t* selected, byte* bytes) const {
+    std::fill(selected, selected + m_entryWords, 0);
+    for (size_t i = 0; i < m_table.size(); i++) {
+        uint64_t mask = ConstantTimeEqualMask(i, index);
+        const uint64_t* entry = &m_words[i * m_entryWords];
+        for (size_t w = 0; w < m_entryWords; w++) {
+            selected[w] |= entry[w] & mask;
+        }
+    }
+
+    for (size_t w = 0; w < m_entryWords; w++) {
+        for (size_t b = 0; b < 8; b++) {
+            bytes[8 * w + b] = byte(selected[w] >> (56 - 8 * b));
+        }
+    }
+    return Integer(bytes, 8 * m_entryWords);
+}
+
+Integer FixedBaseTable::Exp(const Integer& exponent) const {
+    return Exp(exponent, *m_ctx);
+}
+
+Integer FixedBaseTable::Exp(const Integer& exponent, const ModExpContext& ctx) const {
+    DH_METRIC_TIME("dh_fixed_base_exp_seconds", "Time in comb-table exponentiation");
+    if (!IsBuilt()) {
+        throw InvalidArgument("FixedBaseTable: table has not been built");
+    }
+    if (exponent.IsNegative()) {
+        throw InvalidArgument("FixedBaseTable: negative exponent");
+    }
+    if (ctx.GetModulus() != m_modulus) {
+        throw InvalidArgument("FixedBaseTable: context is for a different modulus");
+    }
+    // Exponents wider than the table fall back to the general engine. Private
+    // keys are drawn below the table width, so they never take this path.
+    if (exponent.BitCount() > m_exponentBits) {
+        return ctx.Exp(m_base, exponent);
+    }
+
+    // Walk all comb columns from the top; column c gathers bit
+    // (j * spacing + c) of the exponent into bit j of the table index. Every
+    // column squares and multiplies, index 0 multiplying by one, and the
+    // entry is selected by scanning the whole table.
+    if (m_fixed) {
+        return m_fixed->Exp(exponent, m_teeth, m_spacing);
+    }
+
+    // Other moduli run the same schedule on Integer arithmetic, which is
+    // not constant-time; the buffers are shared by every column
+    std::vector<byte> bits((m_teeth * m_spacing + 7) / 8);
+    exponent.Encode(bits.data(), bits.size());
+    std::vector<uint64_t> selected(m_entryWords);
+    std::vector<byte> entryBytes(8 * m_entryWords);
+    Integer result = ctx.One();
+    for (size_t col = m_spacing; col-- > 0;) {
+        result = ctx.Square(result);
+
+        size_t index = 0;
+        for (unsigned int j = 0; j < m_teeth; j++) {
+            size_t bit = j * m_spacing + col;
+            index |= size_t((bits[bits.size() - 1 - bit / 8] >> (bit % 8)) & 1) << j;
+        }
+        result = ctx.Multiply(result, SelectEntry(index, selected.data(), entryBytes.data()));
+    }
+
+    return ctx.ConvertOut(result);
+}
+
+Integer FixedBaseTable::DualExp(const Integer& exponent, const FixedBaseTable& other, const Integer& otherExponent,
+                                const ModExpContext& ctx) const {
+    if (!IsBuilt() || !other.IsBuilt()) {
+        throw InvalidArgument("FixedBaseTable: table has not been built");
+    }
+    if (other.m_modulus != m_modulus || other.m_teeth != m_teeth || other.m_spacing != m_spacing ||
+        ctx.GetModulus() != m_modulus) {
+        throw InvalidArgument("FixedBaseTable: tables or context do not match");
+    }
+    if (exponent.IsNegative() || otherExponent.IsNegative()) {
+        throw InvalidArgument("FixedBaseTable: negative exponent");
+    }
+    // Exponents wider than the tables fall back to two separate powers
+    if (exponent.BitCount() > m_exponentBits || otherExponent.BitCount() > other.m_exponentBits) {
+        return a_times_b_mod_c(Exp(exponent, ctx), other.Exp(otherExponent, ctx), m_modulus);
+    }
+
+    Integer result = ctx.One();
+    bool started = false;
+    for (size_t col = m_spacing; col-- > 0;) {
+        if (started) result = ctx.Square(result);
+
+        size_t index = 0, otherIndex = 0;
+        for (unsigned int j = 0; j < m_teeth; j++) {
+            if (exponent.GetBit(j * m_spacing + col)) index |= size_t(1) << j;
+            if (otherExponent.GetBit(j * m_spacing + col)) otherIndex |= size_t(1) << j;
+        }
+        if (index != 0) {
+            result = started ? ctx.Multiply(result, m_table[index]) : m_table[index];
+            started = true;
+        }
+        if (otherIndex != 0) {
+            result = started ? ctx.Multiply(result, other.m_table[otherIndex]) : other.m_table[otherIndex];
+            started = true;
+        }
+    }
+
+    return ctx.ConvertOut(result);
+}
+
+void FixedBaseTable::Save(const std::string& filename) const {
+    size_t header[2] = {m_exponentBits, m_teeth};
+    std::string bytes(kTableMagic, sizeof(kTableMagic));
+    bytes.append(reinterpret_cast<const char*>(header), sizeof(header));
+    AppendInteger(bytes, m_base);
+    AppendInteger(bytes, m_modulus);
+
+    // Entries are stored in standard form so the file does not depend on
+    // the Montgomery radix of the machine that built it
+    for (const Integer& entry : m_table) {
+        AppendInteger(bytes, m_ctx->ConvertOut(entry));
+    }
+    WriteFileBytes(filename, bytes);
+}
+
+bool FixedBaseTable::Load(const std::string& filename, const Integer& base, const Integer& modulus) {
+    try {
+        MappedFile file(filename);
+        size_t header[2];
+        size_t headerSize = sizeof(kTableMagic) + sizeof(header);
+        if (file.Size() < headerSize || std::memcmp(file.Data(), kTableMagic, sizeof(kTableMagic)) != 0) {
+            return false;
+        }
+        std::memcpy(header, file.Data() + sizeof(kTableMagic), sizeof(header));
+
+        IntegerReader reader(file.Data() + headerSize, file.Size() - headerSize, filename);
+        Integer savedBase, savedModulus;
+        reader.Read(savedBase);
+        reader.Read(savedModulus);
+        if (savedModulus != modulus || savedBase != base % modulus || header[1] == 0 || header[1] > 16) {
+            return false;
+        }
+
+        Initialize(base, modulus, header[0], unsigned(header[1]));
+        for (Integer& entry : m_table) {
+            Integer value;
+            reader.Read(value);
+            if (value >= modulus) {
+                throw std::runtime_error("Table entry out of range in " + filename);
+            }
+            entry = m_ctx->ConvertIn(value);
+        }
+        reader.ExpectEnd();
+        PrepareSecretPath();
+        return true;
+    } catch (const std::exception&) {
+        // Missing or damaged tables are rebuilt by the caller
+        m_table.clear();
+        m_words.clear();
+        m_fixed.reset();
+        return false;
+    }
+}
+
+// Function to derive the table file name stored next to a parameter file
+std::string FixedBaseTableFile(const std::string& paramsFile) {
+    std::string::size_type dot = paramsFile.rfind('.');
+    std::string::size_type slash = paramsFile.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return paramsFile + ".comb";
+    }
+    return paramsFile.substr(0, dot) + ".comb";
+}
+
+bool LoadOrBuildFixedBaseTable(FixedBaseTable& table, const std::string& tableFile, const Integer& base,
+                               const Integer& modulus, size_t exponentBits, unsigned int teeth) {
+    if (table.Load(tableFile, base, modulus) && table.Teeth() == teeth && table.ExponentBits() >= exponentBits) {
+        return false;
+    }
+    table.Build(base, modulus, exponentBits, teeth);
+    table.Save(tableFile);
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef FIXED_BASE_H
+#define FIXED_BASE_H
+
+#include "mod_exp.h"
+
+class FixedCombEngine;
+
+// Lim-Lee comb table for exponentiating one fixed base, such as the group
+// generator g, modulo a fixed p. Exponents of up to exponentBits bits are
+// split into `teeth` rows of `spacing` bits; the table holds all 2^teeth
+// products of g^(2^(row * spacing)), so g^x costs `spacing` squarings and
+// `spacing` multiplications. More teeth means a table twice as
+// large for each extra tooth and proportionally fewer operations per call.
+class FixedBaseTable {
+public:
+    FixedBaseTable();
+    ~FixedBaseTable();
+
+    // Function to build the table for base^x mod modulus with x < 2^exponentBits
+    void Build(const CryptoPP::Integer& base, const CryptoPP::Integer& modulus, size_t exponentBits, unsigned int teeth);
+
+    // Function to compute base^exponent mod modulus from the table. For
+    // exponents up to ExponentBits() every call performs the same squarings,
+    // multiplications and full-table scans. Moduli that SecretExpContext
+    // handles (odd, up to 4096 bits) run on FixedMontgomery and are
+    // constant-time, so private keys and DSA nonces may use this; other
+    // moduli fall back to variable-time Integer arithmetic.
+    CryptoPP::Integer Exp(const CryptoPP::Integer& exponent) const;
+
+    // Function to compute the same power using a caller-owned context for
+    // the same modulus, so several threads can share one table
+    CryptoPP::Integer Exp(const CryptoPP::Integer& exponent, const ModExpContext& ctx) const;
+
+    // Function to compute base^exponent * other^otherExponent mod modulus
+    // in one pass: both combs are walked column by column, so the product
+    // costs the squarings of a single exponentiation. Both tables must
+    // share the modulus and shape. This is variable-time and meant for
+    // public exponents such as signature verification.
+    CryptoPP::Integer DualExp(const CryptoPP::Integer& exponent, const FixedBaseTable& other,
+                              const CryptoPP::Integer& otherExponent, const ModExpContext& ctx) const;
+
+    // Function to save the table next to the parameter file
+    void Save(const std::string& filename) const;
+
+    // Function to load a saved table; returns false if the file is missing,
+    // malformed or was built for a different base or modulus
+    bool Load(const std::string& filename, const CryptoPP::Integer& base, const CryptoPP::Integer& modulus);
+
+    bool IsBuilt() const { return !m_table.empty(); }
+    size_t ExponentBits() const { return m_exponentBits; }
+    unsigned int Teeth() const { return m_teeth; }
+    size_t Spacing() const { return m_spacing; }
+    size_t Entries() const { return m_table.size(); }
+    size_t TableBytes() const { return m_table.size() * m_modulus.ByteCount(); }
+    const CryptoPP::Integer& GetBase() const { return m_base; }
+    const CryptoPP::Integer& GetModulus() const { return m_modulus; }
+    const ModExpContext& Context() const { return *m_ctx; }
+
+private:
+    void Initialize(const CryptoPP::Integer& base, const CryptoPP::Integer& modulus, size_t exponentBits, unsigned int teeth);
+    void PrepareSecretPath();
+    CryptoPP::Integer SelectEntry(size_t index, uint64_t* selected, CryptoPP::byte* bytes) const;
+
+    CryptoPP::Integer m_base;
+    CryptoPP::Integer m_modulus;
+    size_t m_exponentBits;
+    unsigned int m_teeth;
+    size_t m_spacing;
+    std::unique_ptr<ModExpContext> m_ctx;
+    std::vector<CryptoPP::Integer> m_table; // Montgomery form
+    size_t m_entryWords;
+    std::unique_ptr<FixedCombEngine> m_fixed; // set when the modulus fits FixedMontgomery
+    std::vector<uint64_t> m_words;            // otherwise m_table packed for masked selection
+};
+
+// Function to derive the table file name stored next to a parameter file
+std::string FixedBaseTableFile(const std::string& paramsFile);
+
+// Function to load the table saved for these parameters, rebuilding and
+// saving it when it is missing or was built with a different shape.
+// Returns true if the table had to be built.
+bool LoadOrBuildFixedBaseTable(FixedBaseTable& table, const std::string& tableFile, const CryptoPP::Integer& base,
+                               const CryptoPP::Integer& modulus, size_t exponentBits, unsigned int teeth);
+
+#endif // FIXED_BASE_H
@@ -0,0 +1,198 @@
+#ifndef FIXED_BIGNUM_H
+#define FIXED_BIGNUM_H
+
+#include "crypto_headers.h"
+#include "cpu_dispatch.h"
+
+// Unsigned integer of exactly Limbs 64-bit words, least significant word
+// first. It lives wherever it is declared, usually the stack, and never
+// allocates; the width is part of the type, so every loop over it runs
+// the same number of iterations whatever the value.
+template <size_t Limbs>
+struct FixedUInt {
+    static const size_t kBits = 64 * Limbs;
+
+    uint64_t limb[Limbs];
+
+    // Function to load a non-negative Integer; throws if it is wider than the type
+    void FromInteger(const CryptoPP::Integer& a) {
+        if (a.IsNegative() || a.BitCount() > kBits) {
+            throw CryptoPP::InvalidArgument("FixedUInt: value does not fit");
+        }
+        CryptoPP::byte bytes[8 * Limbs];
+        a.Encode(bytes, sizeof(bytes));
+        for (size_t i = 0; i < Limbs; i++) {
+            uint64_t word = 0;
+            for (size_t b = 0; b < 8; b++) {
+                word = (word << 8) | bytes[8 * (Limbs - 1 - i) + b];
+            }
+            limb[i] = word;
+        }
+    }
+
+    CryptoPP::Integer ToInteger() const {
+        CryptoPP::byte bytes[8 * Limbs];
+        for (size_t i = 0; i < Limbs; i++) {
+            for (size_t b = 0; b < 8; b++) {
+                bytes[8 * (Limbs - 1 - i) + b] = CryptoPP::byte(limb[i] >> (56 - 8 * b));
+            }
+        }
+        return CryptoPP::Integer(bytes, sizeof(bytes));
+    }
+
+    // Function to read bit `i`, where `i` is public
+    unsigned int Bit(size_t i) const { return unsigned((limb[i / 64] >> (i % 64)) & 1); }
+};
+
+// Function to return all ones if a == b and zero otherwise, without branching
+inline uint64_t ConstantTimeEqualMask(uint64_t a, uint64_t b) {
+    uint64_t diff = a ^ b;
+    return ((diff | (0 - diff)) >> 63) - 1;
+}
+
+// Montgomery arithmetic modulo an odd n of at most 64 * Limbs bits, with
+// R = 2^(64 * Limbs). Multiplication is CIOS (coarsely integrated operand
+// scanning) on 64x64->128-bit products and ends in a masked rather than
+// branching subtraction, and exponentiation uses a fixed window whose
+// table entries are selected by scanning the whole table. Time and memory
+// access therefore depend only on Limbs and the exponent length, never on
+// the values. The context is immutable after construction and may be
+// shared between threads.
+template <size_t Limbs>
+class FixedMontgomery {
+public:
+    typedef FixedUInt<Limbs> Value;
+
+    explicit FixedMontgomery(const CryptoPP::Integer& modulus) {
+        if (modulus.IsEven() || modulus < 3 || modulus.BitCount() > Value::kBits) {
+            throw CryptoPP::InvalidArgument("FixedMontgomery: modulus must be odd and fit the limb count");
+        }
+        m_modulus.FromInteger(modulus);
+
+        // -n^-1 mod 2^64 by Newton iteration; each step doubles the correct bits
+        uint64_t inverse = 1;
+        for (int i = 0; i < 6; i++) {
+            inverse *= 2 - m_modulus.limb[0] * inverse;
+        }
+        m_n0Inverse = 0 - inverse;
+
+        m_r2.FromInteger(CryptoPP::Integer::Power2(2 * Value::kBits) % modulus);
+        m_one.FromInteger(CryptoPP::Integer::Power2(Value::kBits) % modulus);
+    }
+
+    // Function to compute r = a * b / R mod n for a, b < n; r may alias a or b
+    void Multiply(Value& r, const Value& a, const Value& b) const {
+        typedef unsigned __int128 Wide;
+        const uint64_t* n = m_modulus.limb;
+        uint64_t t[Limbs + 2] = {};
+        for (size_t i = 0; i < Limbs; i++) {
+            // t += a * b[i]
+            uint64_t carry = 0;
+            for (size_t j = 0; j < Limbs; j++) {
+                Wide sum = Wide(a.limb[j]) * b.limb[i] + t[j] + carry;
+                t[j] = uint64_t(sum);
+                carry = uint64_t(sum >> 64);
+            }
+            Wide sum = Wide(t[Limbs]) + carry;
+            t[Limbs] = uint64_t(sum);
+            t[Limbs + 1] = uint64_t(sum >> 64);
+
+            // t = (t + m * n) / 2^64, with m chosen to clear the low word
+            uint64_t m = t[0] * m_n0Inverse;
+            sum = Wide(m) * n[0] + t[0];
+            carry = uint64_t(sum >> 64);
+            for (size_t j = 1; j < Limbs; j++) {
+                sum = Wide(m) * n[j] + t[j] + carry;
+                t[j - 1] = uint64_t(sum);
+                carry = uint64_t(sum >> 64);
+            }
+            sum = Wide(t[Limbs]) + carry;
+            t[Limbs - 1] = uint64_t(sum);
+            t[Limbs] = t[Limbs + 1] + uint64_t(sum >> 64);
+        }
+
+        // t < 2n: subtract n and keep the difference unless it borrowed
+        uint64_t difference[Limbs];
+        uint64_t borrow = 0;
+        for (size_t j = 0; j < Limbs; j++) {
+            Wide diff = Wide(t[j]) - n[j] - borrow;
+            difference[j] = uint64_t(diff);
+            borrow = uint64_t(diff >> 64) & 1;
+        }
+        uint64_t keepDifference = (uint64_t((Wide(t[Limbs]) - borrow) >> 64) & 1) - 1;
+        for (size_t j = 0; j < Limbs; j++) {
+            r.limb[j] = (difference[j] & keepDifference) | (t[j] & ~keepDifference);
+        }
+    }
+
+    // Function to convert a < n into Montgomery form, a * R mod n
+    void ConvertIn(Value& r, const Value& a) const { Multiply(r, a, m_r2); }
+
+    // Function to convert out of Montgomery form
+    void ConvertOut(Value& r, const Value& a) const {
+        Value one = {};
+        one.limb[0] = 1;
+        Multiply(r, a, one);
+    }
+
+    // Function to compute r = base^exponent mod n for base < n and
+    // exponent < 2^exponentBits. Every call with the same exponentBits
+    // performs the same squarings, multiplications and table scans.
+    void Exp(Value& r, const Value& base, const Value& exponent, size_t exponentBits) const {
+        if (exponentBits == 0 || exponentBits > Value::kBits) {
+            throw CryptoPP::InvalidArgument("FixedMontgomery: exponent length out of range");
+        }
+        // The window width depends only on the public exponent length
+        const unsigned int windowBits = exponentBits <= 512 ? 4 : 5;
+        const size_t entries = size_t(1) << windowBits;
+
+        Value table[32];
+        table[0] = m_one;
+        ConvertIn(table[1], base);
+        for (size_t i = 2; i < entries; i++) {
+            Multiply(table[i], table[i - 1], table[1]);
+        }
+
+        size_t windows = (exponentBits + windowBits - 1) / windowBits;
+        Value acc = m_one, selected;
+        for (size_t w = windows; w-- > 0;) {
+            if (w + 1 != windows) {
+                for (unsigned int s = 0; s < windowBits; s++) {
+                    Multiply(acc, acc, acc);
+                }
+            }
+            uint64_t index = 0;
+            for (unsigned int b = windowBits; b-- > 0;) {
+                size_t bit = w * windowBits + b;
+                index = (index << 1) | (bit < exponentBits ? exponent.Bit(bit) : 0);
+            }
+            Select(selected, table, entries, index);
+            Multiply(acc, acc, selected);
+        }
+        ConvertOut(r, acc);
+    }
+
+    const Value& Modulus() const { return m_modulus; }
+    const Value& One() const { return m_one; }
+
+    // Function to copy table[index] into r while reading every entry
+    static void Select(Value& r, const Value* table, size_t entries, uint64_t index) {
+        for (size_t j = 0; j < Limbs; j++) {
+            r.limb[j] = 0;
+        }
+        for (size_t i = 0; i < entries; i++) {
+            uint64_t mask = ConstantTimeEqualMask(i, index);
+            for (size_t j = 0; j < Limbs; j++) {
+                r.limb[j] |= table[i].limb[j] & mask;
+            }
+        }
+    }
+
+private:
+    Value m_modulus;
+    uint64_t m_n0Inverse;
+    Value m_r2;  // R^2 mod n
+    Value m_one; // R mod n, 1 in Montgomery form
+};
+
+#endif // FIXED_BIGNUM_H
@@ -0,0 +1,100 @@
+#include "batch_exp.h"
+#include "fixed_base.h"
+#include "key_batch.h"
+#include "key_store.h"
+
+using namespace CryptoPP;
+
+// Private keys generated and exponentiated per batched call
+static const size_t kBatchKeys = 64;
+
+int main(int argc, char* argv[]) {
+    size_t count = 0;
+    bool lanes = false;
+    unsigned int teeth = 8;
+    bool validArgs = argc >= 3 && argc <= 4;
+    if (validArgs) {
+        // A malformed number prints the usage rather than escaping main()
+        try {
+            count = std::stoul(argv[1]);
+            lanes = argc == 4 && std::string(argv[3]) == "batch";
+            if (argc == 4 && !lanes) {
+                teeth = std::stoul(argv[3]);
+            }
+        } catch (const std::logic_error&) {
+            validArgs = false;
+        }
+    }
+    if (!validArgs) {
+        std::cerr << "Usage: " << argv[0] << " <count> <output_file> [teeth|batch]" << std::endl;
+        std::cerr << "batch computes public keys in vector lanes instead of with the fixed-base table" << std::endl;
+        return 1;
+    }
+    std::string outputFile = argv[2];
+
+    try {
+        // Load the parameter set and the fixed-base table once for the whole batch
+        Integer p, q, g;
+        LoadIntegersFromFile("params.bin", p, q, g);
+
+        FixedBaseTable table;
+        std::unique_ptr<BatchExpContext> batch;
+        auto setupStart = std::chrono::steady_clock::now();
+        if (lanes) {
+            batch.reset(new BatchExpContext(p));
+            auto setupEnd = std::chrono::steady_clock::now();
+            std::cout << "Batched kernel: " << BatchKernelName(batch->Kernel()) << ", " << batch->Lanes() << " lanes, "
+                      << std::chrono::duration<double, std::milli>(setupEnd - setupStart).count() << " ms" << std::endl;
+        } else {
+            bool built = LoadOrBuildFixedBaseTable(table, FixedBaseTableFile("params.bin"), g, p, q.BitCount(), teeth);
+            auto setupEnd = std::chrono::steady_clock::now();
+            std::cout << (built ? "Built" : "Loaded") << " fixed-base table: " << table.Entries() << " entries, "
+                      << table.TableBytes() / 1024.0 << " KiB, "
+                      << std::chrono::duration<double, std::milli>(setupEnd - setupStart).count() << " ms" << std::endl;
+        }
+
+        AutoSeededRandomPool rng;
+        KeyPairBatchWriter writer(outputFile, q.MinEncodedSize(), p.MinEncodedSize());
+        KeyPair pair;
+        std::vector<Integer> bases(kBatchKeys, g), privateKeys(kBatchKeys), publicKeys;
+
+        auto start = std::chrono::steady_clock::now();
+        if (lanes) {
+            for (size_t i = 0; i < count; i += kBatchKeys) {
+                size_t n = std::min(kBatchKeys, count - i);
+                for (size_t k = 0; k < n; k++) {
+                    privateKeys[k].Randomize(rng, 1, q - 1);
+                }
+                publicKeys.resize(n);
+                batch->Exp(bases.data(), privateKeys.data(), n, q.BitCount(), publicKeys.data());
+                for (size_t k = 0; k < n; k++) {
+                    pair.privateKey = privateKeys[k];
+                    pair.publicKey = publicKeys[k];
+                    writer.Append(pair);
+                }
+            }
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                // Generate private key in the range [1, q-1], as privateKeyGen does
+                pair.privateKey.Randomize(rng, 1, q - 1);
+                pair.publicKey = table.Exp(pair.privateKey);
+                writer.Append(pair);
+            }
+        }
+        writer.Close();
+        auto end = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << "Generated " << count << " key pairs into " << outputFile << " in " << seconds << " s ("
+                  << (seconds > 0 ? count / seconds : 0.0) << " keys/s)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// g++ -O2 -o test generate_keypairs.cpp batch_exp.cpp key_batch.cpp key_store.cpp dh_container.cpp fixed_base.cpp mod_exp.cpp metrics.cpp -lcryptopp
+// ./test 100000 keypairs.bin 8
+// ./test 100000 keypairs.bin batch
@@ -1,134 +1,92 @@
-#include "crypto_headers.h"
+#include "key_agreement.h"
+#include "key_store.h"
 
 typedef CryptoPP::Integer Integer;
 typedef CryptoPP::byte byte;
-
-// Function to perform modular exponentiation
-Integer ModExp(const Integer& base, const Integer& exponent, const Integer& modulus) {
-    Integer result = 1;
-    Integer b = base % modulus;
-    Integer e = exponent;
-    
-    // Exponentiation by squaring
-    while (e > 0) {
-        if (e.GetBit(0)) {
-            result = (result * b) % modulus;
-        }
-        e >>= 1;
-        b = (b * b) % modulus;
-    }
-    return result;
-}
-
-// Function to load integers from a binary file
-void LoadIntegersFromFile(const std::string& filename, Integer& p, Integer& q, Integer& g) {
-    // Open file for binary reading
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Error opening file for reading: " << filename << std::endl;
-        return;
-    }
-
-    // Read sizes and data
-    size_t size;
-    
-    // Read p
-    file.read(reinterpret_cast<char*>(&size), sizeof(size_t));
-    std::string pStr(size, 0);
-    file.read(&pStr[0], size);
-    p.Decode(reinterpret_cast<const byte*>(pStr.data()), size);
-
-    // Read q
-    file.read(reinterpret_cast<char*>(&size), sizeof(size_t));
-    std::string qStr(size, 0);
-    file.read(&qStr[0], size);
-    q.Decode(reinterpret_cast<const byte*>(qStr.data()), size);
-
-    // Read g
-    file.read(reinterpret_cast<char*>(&size), sizeof(size_t));
-    std::string gStr(size, 0);
-    file.read(&gStr[0], size);
-    g.Decode(reinterpret_cast<const byte*>(gStr.data()), size);
-
-    file.close();
-}
-
-// Function to load private key from a binary file
-void LoadPrivateKey(const std::string& filename, Integer& a) {
-    // Open file for binary reading
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Error opening file for reading: " << filename << std::endl;
-        return;
-    }
-
-    // Read sizes and data
-    size_t size;
-    
-    // Read private key
-    file.read(reinterpret_cast<char*>(&size), sizeof(size_t));
-    std::string aStr(size, 0);
-    file.read(&aStr[0], size);
-    a.Decode(reinterpret_cast<const byte*>(aStr.data()), size);
-
-    file.close();
-}
-
-// Function to save an integer to a binary file
-void SaveIntegerToFile(const std::string& filename, const Integer& a) {
-    // Open file for binary writing
-    std::ofstream file(filename, std::ios::binary);
-    if (!file) {
-        std::cerr << "Error opening file for writing: " << filename << std::endl;
-        return;
-    }
-
-    // Serialize the Integer to a byte array
-    std::string aStr(a.MinEncodedSize(), 0);
-    a.Encode(reinterpret_cast<byte*>(&aStr[0]), aStr.size());
-
-    // Write size followed by the data
-    size_t aSize = aStr.size();
-    file.write(reinterpret_cast<const char*>(&aSize), sizeof(size_t));
-    file.write(aStr.data(), aSize);
-    file.close();
-}
+typedef CryptoPP::SecByteBlock SecByteBlock;
 
 int main(int argc, char* argv[]) {
     // Check if the correct number of command-line arguments is provided
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <alice|bob>" << std::endl;
+    std::string groupName = "modp";
+    unsigned int teeth = 0;
+    bool validArgs = argc % 2 == 0;
+    for (int i = 2; validArgs && i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--fixed-base") {
+            // A malformed count prints the usage rather than escaping main()
+            try {
+                teeth = std::stoul(argv[i + 1]);
+            } catch (const std::logic_error&) {
+                validArgs = false;
+            }
+        } else if (option == "--group") {
+            groupName = argv[i + 1];
+        } else {
+            validArgs = false;
+        }
+    }
+    if (!validArgs) {
+        std::cerr << "Usage: " << argv[0] << " <alice|bob> [--fixed-base <teeth>] [--group <group>]"
+                  << std::endl;
         return 1;
     }
 
     std::string party = argv[1];
-    Integer p, q, g, a;
-
-    // Load parameters from the common file
-    LoadIntegersFromFile("params.bin", p, q, g);
-
+    std::string privateKeyFile, publicKeyFile;
     if (party == "Alice") {
-        // Load Alice's private key and generate her public key
-        LoadPrivateKey("privatekeyA.bin", a);
-        Integer KA = ModExp(g, a, p);
-        SaveIntegerToFile("publicKeyA.bin", KA);
-        std::cout << "Alice's public key generated and saved to publicKeyA.bin" << std::endl;
+        privateKeyFile = "privatekeyA.bin";
+        publicKeyFile = "publicKeyA.bin";
     } else if (party == "Bob") {
-        // Load Bob's private key and generate his public key
-        LoadPrivateKey("privatekeyB.bin", a);
-        Integer KB = ModExp(g, a, p);
-        SaveIntegerToFile("publicKeyB.bin", KB);
-        std::cout << "Bob's public key generated and saved to publicKeyB.bin" << std::endl;
+        privateKeyFile = "privatekeyB.bin";
+        publicKeyFile = "publicKeyB.bin";
     } else {
         std::cerr << "Invalid argument. Please specify 'alice' or 'bob'." << std::endl;
         return 1;
     }
 
+    try {
+        FixedBaseTable table;
+        if (teeth > 0) {
+            if (groupName != "modp") {
+                throw std::runtime_error("--fixed-base applies only to params.bin; named groups have a built-in table");
+            }
+            // Fixed-base mode: reuse the comb table of powers of g kept next to
+            // params.bin; private keys are below q, so q sets the exponent length
+            Integer p, q, g;
+            LoadIntegersFromFile("params.bin", p, q, g);
+            std::string tableFile = FixedBaseTableFile("params.bin");
+
+            auto start = std::chrono::steady_clock::now();
+            bool built = LoadOrBuildFixedBaseTable(table, tableFile, g, p, q.BitCount(), teeth);
+            auto end = std::chrono::steady_clock::now();
+
+            std::cout << (built ? "Built" : "Loaded") << " fixed-base table " << tableFile << ": "
+                      << table.Teeth() << " teeth, " << table.Entries() << " entries, "
+                      << table.TableBytes() / 1024.0 << " KiB, " << table.Spacing()
+                      << " squarings per key, "
+                      << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+        }
+        std::unique_ptr<KeyAgreementBackend> group =
+            MakeKeyAgreementBackend(groupName, "params.bin", table.IsBuilt() ? &table : nullptr);
+
+        Integer a;
+        LoadIntegerFromFile(privateKeyFile, a);
+        SecByteBlock privateKey(group->PrivateKeyLength()), publicKey(group->PublicKeyLength());
+        IntegerToKey(a, privateKey, privateKey.size());
+        group->GeneratePublicKey(privateKey, publicKey);
+
+        SaveIntegerToFile(publicKeyFile, KeyToInteger(publicKey, publicKey.size()));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << party << "'s public key generated and saved to " << publicKeyFile << std::endl;
+
     return 0;
 }
 
 
-// g++ -o test generate_public_key.cpp -lcryptopp
-// ./test alice
-// ./test bob
-
+// g++ -o test generate_public_key.cpp key_agreement.cpp named_groups.cpp secret_exp.cpp mod_exp.cpp fixed_base.cpp key_store.cpp dh_container.cpp metrics.cpp -lcryptopp -lpthread
+// ./test Alice
+// ./test Bob --fixed-base 8
+// ./test Alice --group x25519
@@ -0,0 +1,149 @@
+#include "handshake.h"
+#include "certificate.h"
+#include "key_store.h"
+#include "metrics.h"
+
+using namespace CryptoPP;
+
+HandshakeContext::HandshakeContext(const DSA::PrivateKey& caKey, const HandshakeConfig& config)
+    : m_config(config), m_modp(config.group == "modp"), m_kdf(config.kdf) {
+    if (m_modp) {
+        LoadIntegersFromFile(config.paramsFile, m_p, m_q, m_g);
+    }
+    SetUp(caKey);
+}
+
+HandshakeContext::HandshakeContext(const DSA::PrivateKey& caKey, const Integer& p, const Integer& q, const Integer& g,
+                                   const HandshakeConfig& config)
+    : m_config(config), m_modp(true), m_p(p), m_q(q), m_g(g), m_kdf(config.kdf) {
+    m_config.group = "modp";
+    SetUp(caKey);
+}
+
+void HandshakeContext::SetUp(const DSA::PrivateKey& caKey) {
+    if (m_modp) {
+        m_gTable.Build(m_g, m_p, m_q.BitCount(), m_config.teeth);
+    } else {
+        // Rejects an unknown group name before any thread starts
+        MakeBackend();
+    }
+    DSA::PublicKey caPublicKey;
+    caKey.MakePublicKey(caPublicKey);
+    m_signer.reset(new SigningEngine(caKey, m_config.nonces));
+    m_verifier.reset(new CertificateVerifier(caPublicKey));
+}
+
+std::unique_ptr<KeyAgreementBackend> HandshakeContext::MakeBackend() const {
+    if (m_modp) {
+        return std::unique_ptr<KeyAgreementBackend>(new ModpBackend(m_p, m_q, m_g, &m_gTable));
+    }
+    // Named groups share a comb table built on first use
+    return MakeKeyAgreementBackend(m_config.group);
+}
+
+HandshakeSession::HandshakeSession(const HandshakeContext& context)
+    : m_context(context), m_backend(context.MakeBackend()), m_caCtx(context.Signer().GetModulus()),
+      m_alicePrivate(m_backend->PrivateKeyLength()), m_alicePublic(m_backend->PublicKeyLength()),
+      m_bobPrivate(m_backend->PrivateKeyLength()), m_bobPublic(m_backend->PublicKeyLength()),
+      m_peerKey(m_backend->PublicKeyLength()) {}
+
+bool HandshakeSession::Run(HandshakeResult& result) {
+    DH_METRIC_TIME("dh_handshake_seconds", "Wall time of one in-memory Alice/Bob exchange");
+    const KeyAgreementBackend& group = *m_backend;
+    const HandshakeConfig& config = m_context.Config();
+
+    // Private and public key generation
+    group.GenerateKeyPair(m_rng, m_alicePrivate, m_alicePublic);
+    group.GenerateKeyPair(m_rng, m_bobPrivate, m_bobPublic);
+
+    // Certificate generation by the CA
+    const SigningEngine& signer = m_context.Signer();
+    result.aliceCertificate =
+        signer.Issue(KeyToInteger(m_alicePublic, m_alicePublic.size()), config.binaryCertificates, m_caCtx, m_rng);
+    result.bobCertificate =
+        signer.Issue(KeyToInteger(m_bobPublic, m_bobPublic.size()), config.binaryCertificates, m_caCtx, m_rng);
+
+    // Each side verifies the other's certificate, then derives the session
+    // key from the public key it carries
+    const CertificateVerifier& verifier = m_context.Verifier();
+    result.aliceSecret.resize(group.AgreedValueLength());
+    result.bobSecret.resize(group.AgreedValueLength());
+    struct Side {
+        const std::string& peerCertificate;
+        const byte* privateKey;
+        byte* secret;
+    } sides[] = {{result.bobCertificate, m_alicePrivate, result.aliceSecret},
+                 {result.aliceCertificate, m_bobPrivate, result.bobSecret}};
+    for (const Side& side : sides) {
+        if (!verifier.Verify(side.peerCertificate, m_caCtx)) {
+            throw std::runtime_error("Peer certificate failed verification");
+        }
+        IntegerToKey(CertificatePublicKey(side.peerCertificate), m_peerKey, m_peerKey.size());
+        if (!group.Agree(side.secret, side.privateKey, m_peerKey)) {
+            throw std::runtime_error("Peer public key is not a valid " + group.Name() + " key");
+        }
+    }
+
+    // Fixed-length session keys, compared as md5sum compares the files
+    const SessionKdf& kdf = m_context.Kdf();
+    result.aliceKeys.resize(kdf.OutputLength());
+    result.bobKeys.resize(kdf.OutputLength());
+    kdf.Derive(result.aliceSecret, result.aliceSecret.size(), result.aliceKeys);
+    kdf.Derive(result.bobSecret, result.bobSecret.size(), result.bobKeys);
+    return VerifyBufsEqual(result.aliceKeys, result.bobKeys, result.aliceKeys.size());
+}
+
+HandshakeStats RunHandshakes(const HandshakeContext& context, unsigned long long count, unsigned int threads) {
+    threads = std::max(1u, threads);
+    std::atomic<unsigned long long> next(0), mismatched(0);
+    std::vector<std::vector<double>> latencies(threads);
+    std::mutex failureMutex;
+    std::exception_ptr failure;
+
+    // Threads claim exchanges one at a time until `count` have been handed
+    // out or one of them fails
+    auto worker = [&](unsigned int t) {
+        try {
+            HandshakeSession session(context);
+            HandshakeResult result;
+            while (next++ < count) {
+                auto begin = std::chrono::steady_clock::now();
+                bool match = session.Run(result);
+                auto end = std::chrono::steady_clock::now();
+                if (!match) {
+                    mismatched++;
+                }
+                latencies[t].push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+            next = count;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threads; t++) {
+        workers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    HandshakeStats stats;
+    for (const std::vector<double>& perThread : latencies) {
+        stats.latencies.insert(stats.latencies.end(), perThread.begin(), perThread.end());
+    }
+    stats.completed = stats.latencies.size();
+    stats.mismatched = mismatched;
+    stats.seconds = std::chrono::duration<double>(end - start).count();
+    return stats;
+}
@@ -0,0 +1,107 @@
+#ifndef HANDSHAKE_H
+#define HANDSHAKE_H
+
+#include "key_agreement.h"
+#include "certificate_signer.h"
+#include "certificate_verifier.h"
+#include "session_kdf.h"
+
+// The whole protocol in memory: each exchange runs every phase the file
+// tools run, without touching disk or calling md5sum. Alice and Bob each
+// draw a key pair, the CA certifies both public keys, each side verifies
+// the other's certificate, reads the peer's key out of it, derives the
+// shared secret and expands it into session keys, and the two sides'
+// keys are compared byte for byte.
+
+struct HandshakeConfig {
+    std::string group = "modp";       // "modp", a named group, "x25519" or "p256"
+    std::string paramsFile = "params.bin"; // p, q and g for "modp" when none are given
+    unsigned int teeth = 8;           // comb teeth for the modp generator
+    bool binaryCertificates = true;   // binary or text certificate encoding
+    NoncePoolConfig nonces;           // CA signing nonces; depth 0 signs inline
+    std::vector<KdfOutput> kdf = {{kDefaultKdfLabel, kDefaultKdfLength}}; // session keys per side
+};
+
+// The last exchange a session ran
+struct HandshakeResult {
+    std::string aliceCertificate;
+    std::string bobCertificate;
+    CryptoPP::SecByteBlock aliceSecret; // derived by Alice from Bob's certificate
+    CryptoPP::SecByteBlock bobSecret;   // derived by Bob from Alice's certificate
+    CryptoPP::SecByteBlock aliceKeys;   // HandshakeConfig::kdf outputs, back to back
+    CryptoPP::SecByteBlock bobKeys;
+};
+
+struct HandshakeStats {
+    unsigned long long completed = 0;
+    unsigned long long mismatched = 0; // exchanges whose two sides' keys differed
+    double seconds = 0;
+    std::vector<double> latencies;     // microseconds per exchange
+
+    double HandshakesPerSecond() const { return seconds > 0 ? completed / seconds : 0; }
+};
+
+class HandshakeSession;
+
+// What every exchange shares, set up once: the key-agreement group (with
+// its comb table for g), the CA's signing engine, a verifier for the CA
+// key and the session-key KDF. Read-only after construction, so any
+// number of threads can run exchanges against it, each through its own
+// HandshakeSession.
+class HandshakeContext {
+public:
+    // Function to set up the group named in `config`, reading p, q and g
+    // from config.paramsFile for "modp"
+    HandshakeContext(const CryptoPP::DSA::PrivateKey& caKey, const HandshakeConfig& config);
+
+    // Function to set up the "modp" group from parameters already in memory
+    HandshakeContext(const CryptoPP::DSA::PrivateKey& caKey, const CryptoPP::Integer& p, const CryptoPP::Integer& q,
+                     const CryptoPP::Integer& g, const HandshakeConfig& config);
+
+    HandshakeContext(const HandshakeContext&) = delete;
+    HandshakeContext& operator=(const HandshakeContext&) = delete;
+
+    // Function to create a key-agreement backend for one thread
+    std::unique_ptr<KeyAgreementBackend> MakeBackend() const;
+
+    const HandshakeConfig& Config() const { return m_config; }
+    const SigningEngine& Signer() const { return *m_signer; }
+    const CertificateVerifier& Verifier() const { return *m_verifier; }
+    const SessionKdf& Kdf() const { return m_kdf; }
+
+private:
+    void SetUp(const CryptoPP::DSA::PrivateKey& caKey);
+
+    HandshakeConfig m_config;
+    bool m_modp;
+    CryptoPP::Integer m_p, m_q, m_g;
+    FixedBaseTable m_gTable;
+    std::unique_ptr<SigningEngine> m_signer;
+    std::unique_ptr<CertificateVerifier> m_verifier;
+    SessionKdf m_kdf;
+};
+
+// One thread's scratch state: its own backend, CA-modulus context, RNG and
+// key buffers, reused across exchanges
+class HandshakeSession {
+public:
+    explicit HandshakeSession(const HandshakeContext& context);
+
+    // Function to run one complete exchange into `result`; returns true if
+    // both sides derived the same session keys. Throws if a certificate fails
+    // verification or a peer key is not a valid group element.
+    bool Run(HandshakeResult& result);
+
+private:
+    const HandshakeContext& m_context;
+    std::unique_ptr<KeyAgreementBackend> m_backend;
+    ModExpContext m_caCtx;
+    CryptoPP::AutoSeededRandomPool m_rng;
+    CryptoPP::SecByteBlock m_alicePrivate, m_alicePublic, m_bobPrivate, m_bobPublic, m_peerKey;
+};
+
+// Function to run `count` exchanges spread over `threads` threads, each
+// with its own session; rethrows the first error any thread hit
+HandshakeStats RunHandshakes(const HandshakeContext& context, unsigned long long count, unsigned int threads);
+
+#endif // HANDSHAKE_H
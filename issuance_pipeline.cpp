@@ -0,0 +1,175 @@
+#include "issuance_pipeline.h"
+#include "certificate.h"
+#include "certificate_stream.h"
+#include "key_store.h"
+#include "dh_container.h"
+
+using namespace CryptoPP;
+
+// A job as it moves through the stages; a job that failed carries its
+// error forward so the writer still sees every index
+struct IssuanceItem {
+    size_t index = 0;
+    Integer publicKey;
+    std::string signature;
+    std::string certificate;
+    std::string error;
+};
+
+// Function to add the time since `start` to a stage's busy counter
+static void AddBusyTime(std::atomic<long long>& counter, std::chrono::steady_clock::time_point start) {
+    counter += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+IssuancePipeline::IssuancePipeline(const DSA::PrivateKey& caKey, const IssuanceOptions& options)
+    : m_options(options), m_engine(caKey, options.pool) {
+    if (options.signerThreads == 0) {
+        throw InvalidArgument("IssuancePipeline: at least one signer thread is required");
+    }
+    if (options.binary && !options.container.empty()) {
+        // Container certificate records hold the text form's key and signature
+        throw InvalidArgument("IssuancePipeline: binary certificates cannot be written to a container");
+    }
+}
+
+void IssuancePipeline::Run(const std::vector<IssuanceJob>& jobs, IssuanceReport& report) {
+    report = IssuanceReport();
+    report.errors.assign(jobs.size(), std::string());
+
+    WorkQueue<IssuanceItem> loaded(m_options.queueDepth);
+    WorkQueue<IssuanceItem> signedItems(m_options.queueDepth);
+    std::atomic<long long> readNanos(0), signNanos(0);
+    auto start = std::chrono::steady_clock::now();
+
+    // Stage 1: load public keys in manifest order
+    std::thread reader([&] {
+        for (size_t i = 0; i < jobs.size(); i++) {
+            auto busy = std::chrono::steady_clock::now();
+            IssuanceItem item;
+            item.index = i;
+            try {
+                LoadIntegerFromFile(jobs[i].publicKeyFile, item.publicKey);
+            } catch (const std::exception& e) {
+                item.error = e.what();
+            }
+            AddBusyTime(readNanos, busy);
+            if (!loaded.Push(std::move(item))) {
+                break;
+            }
+        }
+        loaded.Close();
+    });
+
+    // Stage 2: build, hash and sign the certificate data
+    std::atomic<unsigned int> signersLeft(m_options.signerThreads);
+    auto signerLoop = [&] {
+        // Per-thread scratch: an arena reused for every certificate, and a
+        // context and RNG for nonces the pool could not supply
+        CertificateArena arena;
+        ModExpContext ctx(m_engine.GetModulus());
+        AutoSeededRandomPool rng;
+        IssuanceItem item;
+        while (loaded.Pop(item)) {
+            auto busy = std::chrono::steady_clock::now();
+            if (item.error.empty()) {
+                try {
+                    arena.Reset();
+                    CertificateStreamWriter writer(arena, m_options.binary);
+                    byte hash[SHA256::DIGESTSIZE];
+                    writer.WriteSignedPart(item.publicKey, m_engine.SignatureLength(), hash);
+                    size_t length = m_engine.SignDigest(hash, sizeof(hash), writer.SignatureBuffer(), ctx, rng);
+                    if (m_options.container.empty()) {
+                        writer.WriteSignature(writer.SignatureBuffer(), length);
+                        item.certificate = writer.ToString();
+                    } else {
+                        item.signature.assign(reinterpret_cast<const char*>(writer.SignatureBuffer()), length);
+                    }
+                } catch (const std::exception& e) {
+                    item.error = e.what();
+                }
+            }
+            AddBusyTime(signNanos, busy);
+            if (!signedItems.Push(std::move(item))) {
+                break;
+            }
+        }
+        if (--signersLeft == 0) {
+            signedItems.Close();
+        }
+    };
+    std::vector<std::thread> signers;
+    for (unsigned int i = 0; i < m_options.signerThreads; i++) {
+        signers.emplace_back(signerLoop);
+    }
+
+    // Stage 3 (this thread): write certificates in manifest order. Items
+    // arrive out of order from the signers and wait in `pending` until
+    // every earlier job has been written.
+    std::unique_ptr<ContainerWriter> container;
+    double writeSeconds = 0;
+    try {
+        if (!m_options.container.empty()) {
+            container.reset(new ContainerWriter(m_options.container));
+        }
+
+        std::vector<IssuanceItem> pending(jobs.size());
+        std::vector<char> ready(jobs.size(), 0);
+        size_t nextToWrite = 0;
+        std::deque<IssuanceItem> batch;
+        while (signedItems.PopAll(batch)) {
+            auto busy = std::chrono::steady_clock::now();
+            for (IssuanceItem& item : batch) {
+                size_t index = item.index;
+                pending[index] = std::move(item);
+                ready[index] = 1;
+            }
+            batch.clear();
+
+            for (; nextToWrite < jobs.size() && ready[nextToWrite]; nextToWrite++) {
+                IssuanceItem& item = pending[nextToWrite];
+                if (item.error.empty()) {
+                    try {
+                        if (container) {
+                            container->WriteCertificate(item.publicKey, item.signature);
+                        } else {
+                            std::ofstream out(jobs[nextToWrite].certificateFile, std::ios::binary | std::ios::trunc);
+                            out.write(item.certificate.data(), item.certificate.size());
+                            if (!out) {
+                                throw std::runtime_error("Unable to write file: " + jobs[nextToWrite].certificateFile);
+                            }
+                        }
+                        report.issued++;
+                    } catch (const std::exception& e) {
+                        item.error = e.what();
+                    }
+                }
+                report.errors[nextToWrite] = item.error;
+                item = IssuanceItem();
+            }
+            writeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - busy).count();
+        }
+
+        if (container) {
+            container->Close();
+        }
+    } catch (...) {
+        // Unblock the other stages before unwinding
+        loaded.Close();
+        signedItems.Close();
+        reader.join();
+        for (std::thread& signer : signers) {
+            signer.join();
+        }
+        throw;
+    }
+
+    reader.join();
+    for (std::thread& signer : signers) {
+        signer.join();
+    }
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report.readSeconds = readNanos * 1e-9;
+    report.signSeconds = signNanos * 1e-9;
+    report.writeSeconds = writeSeconds;
+}
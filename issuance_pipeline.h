@@ -0,0 +1,54 @@
+#ifndef ISSUANCE_PIPELINE_H
+#define ISSUANCE_PIPELINE_H
+
+#include "certificate_signer.h"
+
+// One certificate to issue: the subject's public key file and where the
+// certificate goes (unused when writing to a container)
+struct IssuanceJob {
+    std::string publicKeyFile;
+    std::string certificateFile;
+};
+
+struct IssuanceOptions {
+    unsigned int signerThreads = 1;
+    NoncePoolConfig pool;
+    size_t queueDepth = 256;  // items buffered between stages
+    bool binary = false;
+    std::string container;    // if set, every certificate goes into this one container
+};
+
+struct IssuanceReport {
+    size_t issued = 0;
+    std::vector<std::string> errors; // per job; empty if the job succeeded
+    double seconds = 0;
+    // Busy time of each stage, summed over its threads
+    double readSeconds = 0;
+    double signSeconds = 0;
+    double writeSeconds = 0;
+};
+
+// Bulk certificate issuance for the CA. The work is split into stages
+// joined by bounded queues so they overlap: a reader thread loads public
+// key files, signer threads build, hash and sign certificate data, and the
+// calling thread writes finished certificates in manifest order, draining
+// whatever is ready in one go. The signing engine's nonce pool starts
+// with the pipeline and computes the DSA g^k values in the background, so
+// signers mostly do only the cheap mod-q arithmetic. The CA key is loaded
+// once for the whole run.
+class IssuancePipeline {
+public:
+    IssuancePipeline(const CryptoPP::DSA::PrivateKey& caKey, const IssuanceOptions& options);
+
+    // Function to issue a certificate for every job; a job that fails is
+    // reported in its errors slot and does not stop the others
+    void Run(const std::vector<IssuanceJob>& jobs, IssuanceReport& report);
+
+    const SigningEngine& Engine() const { return m_engine; }
+
+private:
+    IssuanceOptions m_options;
+    SigningEngine m_engine;
+};
+
+#endif // ISSUANCE_PIPELINE_H
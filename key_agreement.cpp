@@ -0,0 +1,118 @@
+#include "key_agreement.h"
+#include "named_groups.h"
+#include "key_store.h"
+#include "metrics.h"
+
+using namespace CryptoPP;
+
+ModpBackend::ModpBackend(const Integer& p, const Integer& q, const Integer& g, const FixedBaseTable* gTable,
+                         size_t exponentBits, const std::string& name)
+    : m_p(p), m_q(q), m_g(g), m_exponentBits(q.BitCount()), m_name(name), m_ctx(p), m_secret(p), m_gTable(gTable) {
+    if (exponentBits > 0 && exponentBits < m_exponentBits) {
+        m_exponentBits = exponentBits;
+    }
+    if (gTable && (gTable->GetBase() != g || gTable->GetModulus() != p)) {
+        throw InvalidArgument("ModpBackend: comb table was built for a different group");
+    }
+}
+
+void ModpBackend::GeneratePrivateKey(RandomNumberGenerator& rng, byte* privateKey) const {
+    RandomPrivateExponent(rng, m_q, m_exponentBits).Encode(privateKey, PrivateKeyLength());
+}
+
+void ModpBackend::GeneratePublicKey(const byte* privateKey, byte* publicKey) const {
+    Integer x(privateKey, PrivateKeyLength());
+    Integer y = m_gTable ? m_gTable->Exp(x, m_ctx) : m_secret.Exp(m_g, x, m_exponentBits);
+    y.Encode(publicKey, PublicKeyLength());
+}
+
+bool ModpBackend::Agree(byte* agreedValue, const byte* privateKey, const byte* otherPublicKey) const {
+    Integer y(otherPublicKey, PublicKeyLength());
+    // 0, 1 and p-1 would force the secret into a subgroup of order at most 2
+    if (y <= Integer::One() || y >= m_p - 1) {
+        return false;
+    }
+    Integer x(privateKey, PrivateKeyLength());
+    m_secret.Exp(y, x, m_exponentBits).Encode(agreedValue, AgreedValueLength());
+    return true;
+}
+
+void X25519Backend::GeneratePrivateKey(RandomNumberGenerator& rng, byte* privateKey) const {
+    m_domain.GeneratePrivateKey(rng, privateKey);
+}
+
+void X25519Backend::GeneratePublicKey(const byte* privateKey, byte* publicKey) const {
+    // The RNG argument is part of Crypto++'s interface; neither curve uses it here
+    m_domain.GeneratePublicKey(NullRNG(), privateKey, publicKey);
+}
+
+bool X25519Backend::Agree(byte* agreedValue, const byte* privateKey, const byte* otherPublicKey) const {
+    DH_METRIC_TIME("dh_curve_agree_seconds", "Time in X25519 and P-256 key agreement");
+    // Rejects small-order points, whose shared secret is all zeros
+    return m_domain.Agree(agreedValue, privateKey, otherPublicKey, true);
+}
+
+P256Backend::P256Backend() : m_domain(ASN1::secp256r1()) {}
+
+void P256Backend::GeneratePrivateKey(RandomNumberGenerator& rng, byte* privateKey) const {
+    m_domain.GeneratePrivateKey(rng, privateKey);
+}
+
+void P256Backend::GeneratePublicKey(const byte* privateKey, byte* publicKey) const {
+    m_domain.GeneratePublicKey(NullRNG(), privateKey, publicKey);
+}
+
+bool P256Backend::Agree(byte* agreedValue, const byte* privateKey, const byte* otherPublicKey) const {
+    DH_METRIC_TIME("dh_curve_agree_seconds", "Time in X25519 and P-256 key agreement");
+    return m_domain.Agree(agreedValue, privateKey, otherPublicKey, true);
+}
+
+const std::vector<std::string>& KeyAgreementBackendNames() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> list = {"modp"};
+        for (const NamedGroup& group : NamedGroups()) {
+            list.push_back(group.name);
+        }
+        list.push_back("x25519");
+        list.push_back("p256");
+        return list;
+    }();
+    return names;
+}
+
+std::unique_ptr<KeyAgreementBackend> MakeKeyAgreementBackend(const std::string& name, const std::string& paramsFile,
+                                                             const FixedBaseTable* gTable) {
+    if (name == "modp") {
+        Integer p, q, g;
+        LoadIntegersFromFile(paramsFile, p, q, g);
+        return std::unique_ptr<KeyAgreementBackend>(new ModpBackend(p, q, g, gTable));
+    }
+    if (const NamedGroup* group = FindNamedGroup(name)) {
+        Integer p, q, g;
+        LoadNamedGroup(*group, p, q, g);
+        return std::unique_ptr<KeyAgreementBackend>(
+            new ModpBackend(p, q, g, &NamedGroupTable(*group), group->exponentBits, group->name));
+    }
+    if (name == "x25519") {
+        return std::unique_ptr<KeyAgreementBackend>(new X25519Backend());
+    }
+    if (name == "p256") {
+        return std::unique_ptr<KeyAgreementBackend>(new P256Backend());
+    }
+    std::string available;
+    for (const std::string& known : KeyAgreementBackendNames()) {
+        available += (available.empty() ? "" : ", ") + known;
+    }
+    throw InvalidArgument("Unknown key-agreement group " + name + "; available: " + available);
+}
+
+void IntegerToKey(const Integer& value, byte* key, size_t length) {
+    if (value.IsNegative() || value.MinEncodedSize() > length) {
+        throw std::runtime_error("Key does not fit the group's key length");
+    }
+    value.Encode(key, length);
+}
+
+Integer KeyToInteger(const byte* key, size_t length) {
+    return Integer(key, length);
+}
@@ -0,0 +1,129 @@
+#ifndef KEY_AGREEMENT_H
+#define KEY_AGREEMENT_H
+
+#include "fixed_base.h"
+#include "secret_exp.h"
+
+// One key-agreement group. Keys and agreed values are fixed-length byte
+// strings, the lengths given by the backend, so callers never need to know
+// whether the group is Z_p^* or an elliptic curve. The interface follows
+// Crypto++'s SimpleKeyAgreementDomain. A backend keeps Montgomery scratch
+// state for the modp group and is not safe to share between threads;
+// make one per thread.
+class KeyAgreementBackend {
+public:
+    virtual ~KeyAgreementBackend() {}
+
+    virtual std::string Name() const = 0;
+    virtual size_t PrivateKeyLength() const = 0;
+    virtual size_t PublicKeyLength() const = 0;
+    virtual size_t AgreedValueLength() const = 0;
+
+    // Function to draw a private key into `privateKey`
+    virtual void GeneratePrivateKey(CryptoPP::RandomNumberGenerator& rng, CryptoPP::byte* privateKey) const = 0;
+
+    // Function to compute the public key for a private key
+    virtual void GeneratePublicKey(const CryptoPP::byte* privateKey, CryptoPP::byte* publicKey) const = 0;
+
+    // Function to compute the shared secret with a peer's public key;
+    // returns false if the peer's key is not a valid group element
+    virtual bool Agree(CryptoPP::byte* agreedValue, const CryptoPP::byte* privateKey,
+                       const CryptoPP::byte* otherPublicKey) const = 0;
+
+    // Function to draw a private key and compute its public key
+    void GenerateKeyPair(CryptoPP::RandomNumberGenerator& rng, CryptoPP::byte* privateKey,
+                         CryptoPP::byte* publicKey) const {
+        GeneratePrivateKey(rng, privateKey);
+        GeneratePublicKey(privateKey, publicKey);
+    }
+};
+
+// Finite-field DH over p, q, g from a params file or a named group:
+// private keys in [1, q-1], or below 2^exponentBits when that is shorter,
+// and public keys g^x mod p. Given a comb table for g (which must outlive
+// the backend), public keys are computed from it. Every other
+// exponentiation by a private key runs on the constant-time engine.
+class ModpBackend : public KeyAgreementBackend {
+public:
+    ModpBackend(const CryptoPP::Integer& p, const CryptoPP::Integer& q, const CryptoPP::Integer& g,
+                const FixedBaseTable* gTable = nullptr, size_t exponentBits = 0, const std::string& name = "modp");
+
+    std::string Name() const override { return m_name; }
+    size_t PrivateKeyLength() const override { return (m_exponentBits + 7) / 8; }
+    size_t PublicKeyLength() const override { return m_p.ByteCount(); }
+    size_t AgreedValueLength() const override { return m_p.ByteCount(); }
+
+    void GeneratePrivateKey(CryptoPP::RandomNumberGenerator& rng, CryptoPP::byte* privateKey) const override;
+    void GeneratePublicKey(const CryptoPP::byte* privateKey, CryptoPP::byte* publicKey) const override;
+    bool Agree(CryptoPP::byte* agreedValue, const CryptoPP::byte* privateKey,
+               const CryptoPP::byte* otherPublicKey) const override;
+
+private:
+    CryptoPP::Integer m_p;
+    CryptoPP::Integer m_q;
+    CryptoPP::Integer m_g;
+    size_t m_exponentBits;
+    std::string m_name;
+    ModExpContext m_ctx;
+    SecretExpContext m_secret;
+    const FixedBaseTable* m_gTable;
+};
+
+// X25519 (RFC 7748): 32-byte clamped scalars and u-coordinates
+class X25519Backend : public KeyAgreementBackend {
+public:
+    std::string Name() const override { return "x25519"; }
+    size_t PrivateKeyLength() const override { return CryptoPP::x25519::SECRET_KEYLENGTH; }
+    size_t PublicKeyLength() const override { return CryptoPP::x25519::PUBLIC_KEYLENGTH; }
+    size_t AgreedValueLength() const override { return CryptoPP::x25519::SHARED_KEYLENGTH; }
+
+    void GeneratePrivateKey(CryptoPP::RandomNumberGenerator& rng, CryptoPP::byte* privateKey) const override;
+    void GeneratePublicKey(const CryptoPP::byte* privateKey, CryptoPP::byte* publicKey) const override;
+    bool Agree(CryptoPP::byte* agreedValue, const CryptoPP::byte* privateKey,
+               const CryptoPP::byte* otherPublicKey) const override;
+
+private:
+    CryptoPP::x25519 m_domain;
+};
+
+// ECDH over NIST P-256: 32-byte scalars, uncompressed 65-byte points and
+// the x-coordinate of the shared point as the agreed value. Peer points
+// are checked to lie on the curve.
+class P256Backend : public KeyAgreementBackend {
+public:
+    P256Backend();
+
+    std::string Name() const override { return "p256"; }
+    size_t PrivateKeyLength() const override { return m_domain.PrivateKeyLength(); }
+    size_t PublicKeyLength() const override { return m_domain.PublicKeyLength(); }
+    size_t AgreedValueLength() const override { return m_domain.AgreedValueLength(); }
+
+    void GeneratePrivateKey(CryptoPP::RandomNumberGenerator& rng, CryptoPP::byte* privateKey) const override;
+    void GeneratePublicKey(const CryptoPP::byte* privateKey, CryptoPP::byte* publicKey) const override;
+    bool Agree(CryptoPP::byte* agreedValue, const CryptoPP::byte* privateKey,
+               const CryptoPP::byte* otherPublicKey) const override;
+
+private:
+    CryptoPP::ECDH<CryptoPP::ECP>::Domain m_domain;
+};
+
+// Function to list the names MakeKeyAgreementBackend accepts
+const std::vector<std::string>& KeyAgreementBackendNames();
+
+// Function to create a backend by name: "modp" loads p, q and g from
+// `paramsFile` and uses `gTable` if given; a named group such as
+// "ffdhe2048" uses its built-in constants and shared comb table;
+// "x25519" and "p256" need no parameters
+std::unique_ptr<KeyAgreementBackend> MakeKeyAgreementBackend(const std::string& name,
+                                                             const std::string& paramsFile = "params.bin",
+                                                             const FixedBaseTable* gTable = nullptr);
+
+// Key files and certificates store keys as Integers.
+// Function to read a fixed-length key back out of its Integer form,
+// restoring any leading zero bytes; throws if the value does not fit
+void IntegerToKey(const CryptoPP::Integer& value, CryptoPP::byte* key, size_t length);
+
+// Function to convert a fixed-length key to its Integer form
+CryptoPP::Integer KeyToInteger(const CryptoPP::byte* key, size_t length);
+
+#endif // KEY_AGREEMENT_H
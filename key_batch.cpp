@@ -0,0 +1,87 @@
+#include "key_batch.h"
+
+using namespace CryptoPP;
+
+static const char kBatchMagic[8] = {'D', 'H', 'K', 'E', 'Y', 'S', '0', '1'};
+
+KeyPairBatchWriter::KeyPairBatchWriter(const std::string& filename, size_t privateKeyBytes, size_t publicKeyBytes)
+    : m_file(filename, std::ios::binary), m_filename(filename), m_privateKeyBytes(privateKeyBytes),
+      m_publicKeyBytes(publicKeyBytes), m_count(0), m_record(privateKeyBytes + publicKeyBytes, 0) {
+    if (!m_file) {
+        throw std::runtime_error("Unable to open file for writing: " + filename);
+    }
+
+    // The count is patched in by Close() once every record is written
+    size_t header[3] = {0, m_privateKeyBytes, m_publicKeyBytes};
+    m_file.write(kBatchMagic, sizeof(kBatchMagic));
+    m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+KeyPairBatchWriter::~KeyPairBatchWriter() {
+    if (m_file.is_open()) {
+        try {
+            Close();
+        } catch (const std::exception& e) {
+            std::cerr << "Error closing key batch: " << e.what() << std::endl;
+        }
+    }
+}
+
+void KeyPairBatchWriter::Append(const KeyPair& pair) {
+    if (pair.privateKey.MinEncodedSize() > m_privateKeyBytes || pair.publicKey.MinEncodedSize() > m_publicKeyBytes) {
+        throw std::runtime_error("Key does not fit the record width of " + m_filename);
+    }
+
+    byte* record = reinterpret_cast<byte*>(&m_record[0]);
+    pair.privateKey.Encode(record, m_privateKeyBytes);
+    pair.publicKey.Encode(record + m_privateKeyBytes, m_publicKeyBytes);
+    m_file.write(m_record.data(), m_record.size());
+    m_count++;
+}
+
+void KeyPairBatchWriter::Close() {
+    m_file.seekp(sizeof(kBatchMagic));
+    m_file.write(reinterpret_cast<const char*>(&m_count), sizeof(size_t));
+    m_file.close();
+    if (!m_file) {
+        throw std::runtime_error("Error writing key batch: " + m_filename);
+    }
+}
+
+// Function to load every key pair from a packed key-pair file
+std::vector<KeyPair> LoadKeyPairBatch(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open file: " + filename);
+    }
+
+    char magic[sizeof(kBatchMagic)];
+    size_t header[3];
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, kBatchMagic, sizeof(magic)) != 0 ||
+        !file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        throw std::runtime_error("Invalid key batch header: " + filename);
+    }
+
+    size_t count = header[0], privateKeyBytes = header[1], publicKeyBytes = header[2];
+    std::string record(privateKeyBytes + publicKeyBytes, 0);
+
+    // Reject headers that claim more records than the file holds
+    std::streamoff dataStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff dataBytes = file.tellg() - dataStart;
+    file.seekg(dataStart);
+    if (record.empty() || count > size_t(dataBytes) / record.size()) {
+        throw std::runtime_error("Truncated key batch: " + filename);
+    }
+
+    std::vector<KeyPair> pairs(count);
+    for (KeyPair& pair : pairs) {
+        if (!file.read(&record[0], record.size())) {
+            throw std::runtime_error("Truncated key batch: " + filename);
+        }
+        const byte* data = reinterpret_cast<const byte*>(record.data());
+        pair.privateKey.Decode(data, privateKeyBytes);
+        pair.publicKey.Decode(data + privateKeyBytes, publicKeyBytes);
+    }
+    return pairs;
+}
@@ -0,0 +1,41 @@
+#ifndef KEY_BATCH_H
+#define KEY_BATCH_H
+
+#include "crypto_headers.h"
+
+// A private key and the matching public key g^x mod p
+struct KeyPair {
+    CryptoPP::Integer privateKey;
+    CryptoPP::Integer publicKey;
+};
+
+// Streaming writer for a packed key-pair file. The file starts with an
+// 8-byte magic and three size_t fields (pair count, private key width,
+// public key width), followed by fixed-width big-endian records of
+// private key || public key, so record i sits at a computable offset.
+class KeyPairBatchWriter {
+public:
+    KeyPairBatchWriter(const std::string& filename, size_t privateKeyBytes, size_t publicKeyBytes);
+    ~KeyPairBatchWriter();
+
+    // Function to append one key pair as a fixed-width record
+    void Append(const KeyPair& pair);
+
+    // Function to write the final pair count into the header and close the file
+    void Close();
+
+    size_t Count() const { return m_count; }
+
+private:
+    std::ofstream m_file;
+    std::string m_filename;
+    size_t m_privateKeyBytes;
+    size_t m_publicKeyBytes;
+    size_t m_count;
+    std::string m_record;
+};
+
+// Function to load every key pair from a packed key-pair file
+std::vector<KeyPair> LoadKeyPairBatch(const std::string& filename);
+
+#endif // KEY_BATCH_H
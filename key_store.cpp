@@ -0,0 +1,161 @@
+#include "key_store.h"
+#include "dh_container.h"
+#include "metrics.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace CryptoPP;
+
+MappedFile::MappedFile(const std::string& filename) : m_name(filename), m_data(nullptr), m_size(0), m_mapped(false) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open file: " + filename);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Unable to stat file: " + filename);
+    }
+    m_size = size_t(st.st_size);
+
+    if (m_size >= kMapThreshold) {
+        void* mapped = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Unable to map file: " + filename);
+        }
+        m_data = static_cast<const byte*>(mapped);
+        m_mapped = true;
+    } else if (m_size > 0) {
+        m_buffer.resize(m_size);
+        size_t done = 0;
+        while (done < m_size) {
+            ssize_t n = read(fd, m_buffer.data() + done, m_size - done);
+            if (n <= 0) {
+                close(fd);
+                throw std::runtime_error("Error reading file: " + filename);
+            }
+            done += size_t(n);
+        }
+        m_data = m_buffer.data();
+    }
+    // An empty file has no data at all; it simply fails validation later
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (m_mapped) {
+        munmap(const_cast<byte*>(m_data), m_size);
+    }
+}
+
+void IntegerReader::Read(Integer& a) {
+    size_t size;
+    if (m_size - m_offset < sizeof(size_t)) {
+        throw std::runtime_error("Truncated integer length in " + m_name);
+    }
+    std::memcpy(&size, m_data + m_offset, sizeof(size_t));
+    m_offset += sizeof(size_t);
+
+    if (size == 0 || size > m_size - m_offset) {
+        throw std::runtime_error("Invalid integer length in " + m_name);
+    }
+    a.Decode(m_data + m_offset, size);
+    m_offset += size;
+}
+
+void IntegerReader::ExpectEnd() const {
+    if (!AtEnd()) {
+        throw std::runtime_error("Unexpected trailing data in " + m_name);
+    }
+}
+
+// Function to append one size-prefixed integer to an output buffer
+void AppendInteger(std::string& out, const Integer& a) {
+    size_t size = a.MinEncodedSize();
+    size_t offset = out.size();
+    out.resize(offset + sizeof(size_t) + size);
+    std::memcpy(&out[offset], &size, sizeof(size_t));
+    a.Encode(reinterpret_cast<byte*>(&out[offset + sizeof(size_t)]), size);
+}
+
+// Function to write a whole buffer to a file
+void WriteFileBytes(const std::string& filename, const std::string& bytes) {
+    DH_METRIC_TIME("dh_file_write_seconds", "Time writing key, parameter and session-key files");
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Unable to open file for writing: " + filename);
+    }
+    file.write(bytes.data(), bytes.size());
+    if (!file) {
+        throw std::runtime_error("Error writing file: " + filename);
+    }
+}
+
+// Function to find the first container record whose type matches
+template <typename Match>
+static void FindContainerRecord(const MappedFile& file, ContainerRecord& record, Match match) {
+    ContainerReader reader(file);
+    while (reader.Next(record)) {
+        if (match(record.type)) {
+            return;
+        }
+    }
+    throw std::runtime_error("No matching record in container " + file.Name());
+}
+
+// Function to load the group parameters p, q and g
+void LoadIntegersFromFile(const std::string& filename, Integer& p, Integer& q, Integer& g) {
+    DH_METRIC_TIME("dh_params_load_seconds", "Time in LoadIntegersFromFile");
+    MappedFile file(filename);
+    if (IsContainer(file.Data(), file.Size())) {
+        ContainerRecord record;
+        FindContainerRecord(file, record, [](RecordType type) { return type == RecordType::Params; });
+        ReadParamsRecord(record, filename, p, q, g);
+        return;
+    }
+
+    IntegerReader reader(file);
+    reader.Read(p);
+    reader.Read(q);
+    reader.Read(g);
+    reader.ExpectEnd();
+}
+
+// Function to load a single integer such as a private, public or session key
+void LoadIntegerFromFile(const std::string& filename, Integer& a) {
+    DH_METRIC_TIME("dh_key_load_seconds", "Time in LoadIntegerFromFile");
+    MappedFile file(filename);
+    if (IsContainer(file.Data(), file.Size())) {
+        ContainerRecord record;
+        FindContainerRecord(file, record, [](RecordType type) {
+            return type == RecordType::PrivateKey || type == RecordType::PublicKey || type == RecordType::SessionKey;
+        });
+        ReadKeyRecord(record, filename, a);
+        return;
+    }
+
+    IntegerReader reader(file);
+    reader.Read(a);
+    reader.ExpectEnd();
+}
+
+// Function to save the group parameters p, q and g
+void SaveIntegersToFile(const std::string& filename, const Integer& p, const Integer& q, const Integer& g) {
+    std::string bytes;
+    AppendInteger(bytes, p);
+    AppendInteger(bytes, q);
+    AppendInteger(bytes, g);
+    WriteFileBytes(filename, bytes);
+}
+
+// Function to save a single integer such as a private, public or session key
+void SaveIntegerToFile(const std::string& filename, const Integer& a) {
+    std::string bytes;
+    AppendInteger(bytes, a);
+    WriteFileBytes(filename, bytes);
+}
@@ -0,0 +1,78 @@
+#ifndef KEY_STORE_H
+#define KEY_STORE_H
+
+#include "crypto_headers.h"
+
+// Read-only view of a whole file. Large files are memory-mapped and
+// integers are decoded straight out of the mapped pages; files below
+// kMapThreshold (every params and key file) are pulled in with a single
+// read(), which is cheaper than setting up and tearing down a mapping.
+// Either way a load costs a handful of syscalls rather than a stream
+// buffer plus a temporary string per field.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const CryptoPP::byte* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+    const std::string& Name() const { return m_name; }
+
+    static const size_t kMapThreshold = 64 * 1024;
+
+private:
+    std::string m_name;
+    const CryptoPP::byte* m_data;
+    size_t m_size;
+    bool m_mapped;
+    std::vector<CryptoPP::byte> m_buffer;
+};
+
+// Cursor over a buffer of size-prefixed integers: a host-endian size_t
+// length followed by that many big-endian bytes, as in params.bin and the
+// key files. Every read is bounds-checked against the buffer.
+class IntegerReader {
+public:
+    IntegerReader(const CryptoPP::byte* data, size_t size, const std::string& name)
+        : m_data(data), m_size(size), m_offset(0), m_name(name) {}
+    explicit IntegerReader(const MappedFile& file) : IntegerReader(file.Data(), file.Size(), file.Name()) {}
+
+    // Function to decode the next integer; throws if the record is truncated
+    void Read(CryptoPP::Integer& a);
+
+    // Function to throw unless the whole buffer has been consumed
+    void ExpectEnd() const;
+
+    bool AtEnd() const { return m_offset == m_size; }
+
+private:
+    const CryptoPP::byte* m_data;
+    size_t m_size;
+    size_t m_offset;
+    std::string m_name;
+};
+
+// Function to append one size-prefixed integer to an output buffer
+void AppendInteger(std::string& out, const CryptoPP::Integer& a);
+
+// Function to write a whole buffer to a file
+void WriteFileBytes(const std::string& filename, const std::string& bytes);
+
+// Function to load the group parameters p, q and g; accepts the legacy
+// layout or a container (see dh_container.h) holding a params record
+void LoadIntegersFromFile(const std::string& filename, CryptoPP::Integer& p, CryptoPP::Integer& q, CryptoPP::Integer& g);
+
+// Function to load a single integer such as a private, public or session
+// key; from a container this is the first key record
+void LoadIntegerFromFile(const std::string& filename, CryptoPP::Integer& a);
+
+// Function to save the group parameters p, q and g
+void SaveIntegersToFile(const std::string& filename, const CryptoPP::Integer& p, const CryptoPP::Integer& q, const CryptoPP::Integer& g);
+
+// Function to save a single integer such as a private, public or session key
+void SaveIntegerToFile(const std::string& filename, const CryptoPP::Integer& a);
+
+#endif // KEY_STORE_H
@@ -0,0 +1,183 @@
+#include "metrics.h"
+
+#ifdef DH_ENABLE_METRICS
+
+// Bucket bounds: timers span 1 us to 16 s in steps of 4x, counts 1 to 4096 in steps of 2x
+static std::vector<double> BucketBounds(MetricUnit unit) {
+    std::vector<double> bounds;
+    if (unit == MetricUnit::Seconds) {
+        for (double bound = 1e-6; bound < 20; bound *= 4) {
+            bounds.push_back(bound);
+        }
+    } else {
+        for (double bound = 1; bound <= 4096; bound *= 2) {
+            bounds.push_back(bound);
+        }
+    }
+    return bounds;
+}
+
+MetricHistogram::MetricHistogram(MetricUnit unit)
+    : m_unit(unit), m_bounds(BucketBounds(unit)), m_buckets(new std::atomic<uint64_t>[m_bounds.size() + 1]) {
+    for (size_t i = 0; i <= m_bounds.size(); i++) {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricHistogram::Observe(double value) {
+    size_t bucket = std::lower_bound(m_bounds.begin(), m_bounds.end(), value) - m_bounds.begin();
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    // No fetch_add for atomic<double> before C++20
+    double sum = m_sum.load(std::memory_order_relaxed);
+    while (!m_sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+    }
+}
+
+// Function to write the environment-selected dump when the process exits
+static void DumpMetricsAtExit() {
+    const char* target = std::getenv("DH_METRICS");
+    if (!target || !*target) {
+        return;
+    }
+    std::string path = target;
+    if (path == "-") {
+        WriteMetricsPrometheus(std::cerr);
+        return;
+    }
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Unable to write metrics to " << path << std::endl;
+        return;
+    }
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    if (json) {
+        WriteMetricsJson(out);
+    } else {
+        WriteMetricsPrometheus(out);
+    }
+}
+
+MetricsRegistry& MetricsRegistry::Instance() {
+    // Never destroyed, so the exit hook and late-exiting threads can still use it
+    static MetricsRegistry* registry = [] {
+        std::atexit(DumpMetricsAtExit);
+        return new MetricsRegistry;
+    }();
+    return *registry;
+}
+
+MetricCounter& MetricsRegistry::Counter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& entry = m_entries[name];
+    if (entry.histogram) {
+        throw std::logic_error("Metric " + name + " is already a histogram");
+    }
+    if (!entry.counter) {
+        entry.help = help;
+        entry.counter.reset(new MetricCounter);
+    }
+    return *entry.counter;
+}
+
+MetricHistogram& MetricsRegistry::Histogram(const std::string& name, const std::string& help, MetricUnit unit) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& entry = m_entries[name];
+    if (entry.counter) {
+        throw std::logic_error("Metric " + name + " is already a counter");
+    }
+    if (!entry.histogram) {
+        entry.help = help;
+        entry.histogram.reset(new MetricHistogram(unit));
+    }
+    return *entry.histogram;
+}
+
+void MetricsRegistry::WritePrometheus(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out << std::setprecision(9);
+    for (const auto& item : m_entries) {
+        const std::string& name = item.first;
+        const Entry& entry = item.second;
+        out << "# HELP " << name << ' ' << entry.help << '\n';
+        if (entry.counter) {
+            out << "# TYPE " << name << " counter\n" << name << ' ' << entry.counter->Value() << '\n';
+            continue;
+        }
+        // Prometheus buckets are cumulative
+        const MetricHistogram& h = *entry.histogram;
+        out << "# TYPE " << name << " histogram\n";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < h.Bounds().size(); i++) {
+            cumulative += h.BucketCount(i);
+            out << name << "_bucket{le=\"" << h.Bounds()[i] << "\"} " << cumulative << '\n';
+        }
+        cumulative += h.BucketCount(h.Bounds().size());
+        out << name << "_bucket{le=\"+Inf\"} " << cumulative << '\n';
+        out << name << "_sum " << h.Sum() << '\n' << name << "_count " << h.Count() << '\n';
+    }
+    out.flush();
+}
+
+void MetricsRegistry::WriteJson(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out << std::setprecision(9) << "{\n  \"counters\": {";
+    bool first = true;
+    for (const auto& item : m_entries) {
+        if (item.second.counter) {
+            out << (first ? "" : ",") << "\n    \"" << item.first << "\": " << item.second.counter->Value();
+            first = false;
+        }
+    }
+    out << "\n  },\n  \"histograms\": {";
+    first = true;
+    for (const auto& item : m_entries) {
+        if (!item.second.histogram) {
+            continue;
+        }
+        const MetricHistogram& h = *item.second.histogram;
+        out << (first ? "" : ",") << "\n    \"" << item.first << "\": {\"unit\": \""
+            << (h.Unit() == MetricUnit::Seconds ? "seconds" : "count") << "\", \"count\": " << h.Count()
+            << ", \"sum\": " << h.Sum() << ", \"buckets\": [";
+        for (size_t i = 0; i <= h.Bounds().size(); i++) {
+            out << (i ? ", " : "") << "[";
+            if (i < h.Bounds().size()) {
+                out << h.Bounds()[i];
+            } else {
+                out << "null";
+            }
+            out << ", " << h.BucketCount(i) << "]";
+        }
+        out << "]}";
+        first = false;
+    }
+    out << "\n  }\n}" << std::endl;
+}
+
+bool MetricsEnabled() {
+    return true;
+}
+
+void WriteMetricsPrometheus(std::ostream& out) {
+    MetricsRegistry::Instance().WritePrometheus(out);
+}
+
+void WriteMetricsJson(std::ostream& out) {
+    MetricsRegistry::Instance().WriteJson(out);
+}
+
+#else
+
+bool MetricsEnabled() {
+    return false;
+}
+
+void WriteMetricsPrometheus(std::ostream& out) {
+    out << "# metrics disabled; rebuild with -DDH_ENABLE_METRICS" << std::endl;
+}
+
+void WriteMetricsJson(std::ostream& out) {
+    out << "{\"counters\": {}, \"histograms\": {}}" << std::endl;
+}
+
+#endif // DH_ENABLE_METRICS
@@ -0,0 +1,136 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "crypto_headers.h"
+
+// Process-wide counters and histograms for the hot paths, compiled in
+// only when DH_ENABLE_METRICS is defined (g++ -DDH_ENABLE_METRICS ...).
+// Without it every DH_METRIC_* macro expands to an empty statement and
+// its arguments are not evaluated, so an ordinary build pays nothing.
+//
+//   DH_METRIC_COUNT(name, help, n)      add n to a counter
+//   DH_METRIC_OBSERVE(name, help, v)    record a count-like value, e.g. loop iterations
+//   DH_METRIC_TIME(name, help)          time the rest of the enclosing scope, in seconds
+//
+// Names follow Prometheus conventions: counters end in _total, timers in
+// _seconds. Each call site looks its metric up once, in a function-local
+// static; after that an update is one or two relaxed atomic adds. With
+// DH_METRICS=<file> in the environment, a tool writes every metric to
+// that file when it exits, as JSON if the name ends in .json and as
+// Prometheus text otherwise; "-" writes Prometheus text to stderr.
+
+enum class MetricUnit { Seconds, Count };
+
+// Function to report whether metrics were compiled in
+bool MetricsEnabled();
+
+// Function to write every metric as Prometheus text exposition format
+void WriteMetricsPrometheus(std::ostream& out);
+
+// Function to write every metric as one JSON object
+void WriteMetricsJson(std::ostream& out);
+
+#ifdef DH_ENABLE_METRICS
+
+class MetricCounter {
+public:
+    void Add(uint64_t n) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t Value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+// Histogram with fixed bucket bounds; a value lands in the first bucket
+// whose upper bound is not below it, or in the overflow bucket
+class MetricHistogram {
+public:
+    explicit MetricHistogram(MetricUnit unit);
+
+    void Observe(double value);
+
+    MetricUnit Unit() const { return m_unit; }
+    const std::vector<double>& Bounds() const { return m_bounds; }
+    uint64_t BucketCount(size_t i) const { return m_buckets[i].load(std::memory_order_relaxed); }
+    uint64_t Count() const { return m_count.load(std::memory_order_relaxed); }
+    double Sum() const { return m_sum.load(std::memory_order_relaxed); }
+
+private:
+    MetricUnit m_unit;
+    std::vector<double> m_bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_buckets; // one per bound plus overflow
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<double> m_sum{0};
+};
+
+// Named metrics for the whole process. Lookups lock; updates through the
+// returned references do not. Metrics are never removed, so references
+// stay valid for the life of the process.
+class MetricsRegistry {
+public:
+    static MetricsRegistry& Instance();
+
+    MetricCounter& Counter(const std::string& name, const std::string& help);
+    MetricHistogram& Histogram(const std::string& name, const std::string& help, MetricUnit unit);
+
+    void WritePrometheus(std::ostream& out) const;
+    void WriteJson(std::ostream& out) const;
+
+private:
+    struct Entry {
+        std::string help;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, Entry> m_entries;
+};
+
+// Records the lifetime of the enclosing scope into a histogram
+class MetricTimer {
+public:
+    explicit MetricTimer(MetricHistogram& histogram)
+        : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+    ~MetricTimer() {
+        m_histogram.Observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count());
+    }
+
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    MetricHistogram& m_histogram;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#define DH_METRIC_JOIN2(a, b) a##b
+#define DH_METRIC_JOIN(a, b) DH_METRIC_JOIN2(a, b)
+
+#define DH_METRIC_COUNT(name, help, n)                                                                  \
+    do {                                                                                                \
+        static MetricCounter& dhMetricCounter = MetricsRegistry::Instance().Counter(name, help);       \
+        dhMetricCounter.Add(n);                                                                         \
+    } while (0)
+
+#define DH_METRIC_OBSERVE(name, help, value)                                                            \
+    do {                                                                                                \
+        static MetricHistogram& dhMetricHistogram =                                                     \
+            MetricsRegistry::Instance().Histogram(name, help, MetricUnit::Count);                       \
+        dhMetricHistogram.Observe(value);                                                               \
+    } while (0)
+
+#define DH_METRIC_TIME(name, help)                                                                      \
+    static MetricHistogram& DH_METRIC_JOIN(dhMetricTimed, __LINE__) =                                   \
+        MetricsRegistry::Instance().Histogram(name, help, MetricUnit::Seconds);                         \
+    MetricTimer DH_METRIC_JOIN(dhMetricTimer, __LINE__)(DH_METRIC_JOIN(dhMetricTimed, __LINE__))
+
+#else
+
+#define DH_METRIC_COUNT(name, help, n) do {} while (0)
+#define DH_METRIC_OBSERVE(name, help, value) do {} while (0)
+#define DH_METRIC_TIME(name, help) do {} while (0)
+
+#endif // DH_ENABLE_METRICS
+
+#endif // METRICS_H
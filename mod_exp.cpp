@@ -0,0 +1,127 @@
+#include "mod_exp.h"
+#include "metrics.h"
+
+using namespace CryptoPP;
+
+ModExpContext::ModExpContext(const Integer& modulus, unsigned int windowBits)
+    : m_modulus(modulus), m_windowBits(windowBits) {
+    if (modulus < 2) {
+        throw InvalidArgument("ModExpContext: modulus must be at least 2");
+    }
+    // Montgomery reduction needs an odd modulus; every p and Miller-Rabin
+    // candidate is odd, even moduli fall back to plain reduction
+    if (modulus.IsOdd()) {
+        m_arith.reset(new MontgomeryRepresentation(modulus));
+    } else {
+        m_arith.reset(new ModularArithmetic(modulus));
+    }
+}
+
+// Function to choose the sliding window width for an exponent length
+unsigned int ModExpContext::WindowBits(size_t exponentBits) const {
+    if (m_windowBits != 0) return m_windowBits;
+    if (exponentBits <= 8) return 1;
+    if (exponentBits <= 24) return 2;
+    if (exponentBits <= 80) return 3;
+    if (exponentBits <= 240) return 4;
+    if (exponentBits <= 672) return 5;
+    if (exponentBits <= 1792) return 6;
+    return 7;
+}
+
+Integer ModExpContext::ConvertIn(const Integer& a) const {
+    return m_arith->ConvertIn(a % m_modulus);
+}
+
+Integer ModExpContext::ConvertOut(const Integer& a) const {
+    return m_arith->ConvertOut(a);
+}
+
+const Integer& ModExpContext::Multiply(const Integer& a, const Integer& b) const {
+    return m_arith->Multiply(a, b);
+}
+
+const Integer& ModExpContext::Square(const Integer& a) const {
+    return m_arith->Square(a);
+}
+
+const Integer& ModExpContext::One() const {
+    return m_arith->MultiplicativeIdentity();
+}
+
+Integer ModExpContext::Exp(const Integer& base, const Integer& exponent) const {
+    DH_METRIC_TIME("dh_modexp_seconds", "Time in variable-time Montgomery exponentiation");
+    return m_arith->ConvertOut(ExpMontgomery(base, exponent));
+}
+
+Integer ModExpContext::ExpMontgomery(const Integer& base, const Integer& exponent) const {
+    if (exponent.IsNegative()) {
+        throw InvalidArgument("ModExpContext: negative exponent");
+    }
+    if (exponent.IsZero()) {
+        return One();
+    }
+
+    size_t bits = exponent.BitCount();
+    unsigned int w = WindowBits(bits);
+
+    // Precompute the odd powers b, b^3, ..., b^(2^w - 1) in Montgomery form
+    size_t tableSize = size_t(1) << (w - 1);
+    if (m_table.size() < tableSize) m_table.resize(tableSize);
+    m_table[0] = ConvertIn(base);
+    if (tableSize > 1) {
+        Integer b2 = m_arith->Square(m_table[0]);
+        for (size_t i = 1; i < tableSize; i++) {
+            m_table[i] = m_arith->Multiply(m_table[i - 1], b2);
+        }
+    }
+
+    // Scan the exponent from the top bit, one window of odd value at a time
+    Integer result;
+    bool started = false;
+    long i = long(bits) - 1;
+    while (i >= 0) {
+        if (!exponent.GetBit(i)) {
+            if (started) result = m_arith->Square(result);
+            i--;
+            continue;
+        }
+
+        long j = std::max(i - long(w) + 1, 0L);
+        while (!exponent.GetBit(j)) j++;
+        size_t window = size_t(exponent.GetBits(j, i - j + 1));
+
+        if (started) {
+            for (long k = j; k <= i; k++) result = m_arith->Square(result);
+            result = m_arith->Multiply(result, m_table[window >> 1]);
+        } else {
+            result = m_table[window >> 1];
+            started = true;
+        }
+        i = j - 1;
+    }
+
+    return result;
+}
+
+// Function to perform modular exponentiation with a one-off context
+Integer ModExp(const Integer& base, const Integer& exponent, const Integer& modulus) {
+    ModExpContext ctx(modulus);
+    return ctx.Exp(base, exponent);
+}
+
+// Function to perform bit-at-a-time square-and-multiply (reference implementation)
+Integer ModExpSquareMultiply(const Integer& base, const Integer& exponent, const Integer& modulus) {
+    Integer result = 1;
+    Integer b = base % modulus;
+    Integer e = exponent;
+
+    while (e > 0) {
+        if (e.GetBit(0)) {
+            result = (result * b) % modulus;
+        }
+        e >>= 1;
+        b = (b * b) % modulus;
+    }
+    return result;
+}
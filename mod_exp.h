@@ -0,0 +1,45 @@
+#ifndef MOD_EXP_H
+#define MOD_EXP_H
+
+#include "crypto_headers.h"
+
+// Precomputed modulus context for repeated modular exponentiation.
+// Operands stay in Montgomery form for the whole exponentiation and the
+// exponent is scanned with a sliding window of odd powers. Build one
+// context per modulus and reuse it across calls; a context is not safe to
+// share between threads because it keeps internal scratch buffers.
+class ModExpContext {
+public:
+    // windowBits == 0 picks the window width from the exponent length
+    explicit ModExpContext(const CryptoPP::Integer& modulus, unsigned int windowBits = 0);
+
+    // Function to compute base^exponent mod modulus
+    CryptoPP::Integer Exp(const CryptoPP::Integer& base, const CryptoPP::Integer& exponent) const;
+
+    // Function to compute base^exponent mod modulus, leaving the result in Montgomery form
+    CryptoPP::Integer ExpMontgomery(const CryptoPP::Integer& base, const CryptoPP::Integer& exponent) const;
+
+    // Montgomery-form primitives for callers that chain several operations
+    CryptoPP::Integer ConvertIn(const CryptoPP::Integer& a) const;
+    CryptoPP::Integer ConvertOut(const CryptoPP::Integer& a) const;
+    const CryptoPP::Integer& Multiply(const CryptoPP::Integer& a, const CryptoPP::Integer& b) const;
+    const CryptoPP::Integer& Square(const CryptoPP::Integer& a) const;
+    const CryptoPP::Integer& One() const;
+
+    const CryptoPP::Integer& GetModulus() const { return m_modulus; }
+    unsigned int WindowBits(size_t exponentBits) const;
+
+private:
+    CryptoPP::Integer m_modulus;
+    std::unique_ptr<CryptoPP::ModularArithmetic> m_arith; // Montgomery for odd moduli
+    unsigned int m_windowBits;
+    mutable std::vector<CryptoPP::Integer> m_table;        // odd powers of the base
+};
+
+// Function to perform modular exponentiation with a one-off context
+CryptoPP::Integer ModExp(const CryptoPP::Integer& base, const CryptoPP::Integer& exponent, const CryptoPP::Integer& modulus);
+
+// Function to perform bit-at-a-time square-and-multiply (reference implementation)
+CryptoPP::Integer ModExpSquareMultiply(const CryptoPP::Integer& base, const CryptoPP::Integer& exponent, const CryptoPP::Integer& modulus);
+
+#endif // MOD_EXP_H
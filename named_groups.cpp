@@ -0,0 +1,170 @@
+#include "named_groups.h"
+#include "key_store.h"
+
+using namespace CryptoPP;
+
+// Each prime is p = 2^b - 2^(b-64) - 1 + 2^64 * (floor(2^(b-130) * c) + X),
+// with c = pi for the RFC 3526 groups and c = e for the RFC 7919 groups
+// and X the smallest offset that makes both p and (p-1)/2 prime.
+
+// modp2048, RFC 3526 group 14
+static const char kModp2048Prime[] =
+    "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74"
+    "020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F1437"
+    "4FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7ED"
+    "EE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF05"
+    "98DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB"
+    "9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3B"
+    "E39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF695581718"
+    "3995497CEA956AE515D2261898FA051015728E5A8AACAA68FFFFFFFFFFFFFFFFh";
+
+// modp3072, RFC 3526 group 15
+static const char kModp3072Prime[] =
+    "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74"
+    "020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F1437"
+    "4FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7ED"
+    "EE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF05"
+    "98DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB"
+    "9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3B"
+    "E39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF695581718"
+    "3995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33"
+    "A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7"
+    "ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864"
+    "D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E2"
+    "08E24FA074E5AB3143DB5BFCE0FD108E4B82D120A93AD2CAFFFFFFFFFFFFFFFFh";
+
+// modp4096, RFC 3526 group 16
+static const char kModp4096Prime[] =
+    "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74"
+    "020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F1437"
+    "4FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7ED"
+    "EE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF05"
+    "98DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB"
+    "9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3B"
+    "E39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF695581718"
+    "3995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33"
+    "A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7"
+    "ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864"
+    "D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E2"
+    "08E24FA074E5AB3143DB5BFCE0FD108E4B82D120A92108011A723C12A787E6D7"
+    "88719A10BDBA5B2699C327186AF4E23C1A946834B6150BDA2583E9CA2AD44CE8"
+    "DBBBC2DB04DE8EF92E8EFC141FBECAA6287C59474E6BC05D99B2964FA090C3A2"
+    "233BA186515BE7ED1F612970CEE2D7AFB81BDD762170481CD0069127D5B05AA9"
+    "93B4EA988D8FDDC186FFB7DC90A6C08F4DF435C934063199FFFFFFFFFFFFFFFFh";
+
+// ffdhe2048, RFC 7919
+static const char kFfdhe2048Prime[] =
+    "FFFFFFFFFFFFFFFFADF85458A2BB4A9AAFDC5620273D3CF1D8B9C583CE2D3695"
+    "A9E13641146433FBCC939DCE249B3EF97D2FE363630C75D8F681B202AEC4617A"
+    "D3DF1ED5D5FD65612433F51F5F066ED0856365553DED1AF3B557135E7F57C935"
+    "984F0C70E0E68B77E2A689DAF3EFE8721DF158A136ADE73530ACCA4F483A797A"
+    "BC0AB182B324FB61D108A94BB2C8E3FBB96ADAB760D7F4681D4F42A3DE394DF4"
+    "AE56EDE76372BB190B07A7C8EE0A6D709E02FCE1CDF7E2ECC03404CD28342F61"
+    "9172FE9CE98583FF8E4F1232EEF28183C3FE3B1B4C6FAD733BB5FCBC2EC22005"
+    "C58EF1837D1683B2C6F34A26C1B2EFFA886B423861285C97FFFFFFFFFFFFFFFFh";
+
+// ffdhe3072, RFC 7919
+static const char kFfdhe3072Prime[] =
+    "FFFFFFFFFFFFFFFFADF85458A2BB4A9AAFDC5620273D3CF1D8B9C583CE2D3695"
+    "A9E13641146433FBCC939DCE249B3EF97D2FE363630C75D8F681B202AEC4617A"
+    "D3DF1ED5D5FD65612433F51F5F066ED0856365553DED1AF3B557135E7F57C935"
+    "984F0C70E0E68B77E2A689DAF3EFE8721DF158A136ADE73530ACCA4F483A797A"
+    "BC0AB182B324FB61D108A94BB2C8E3FBB96ADAB760D7F4681D4F42A3DE394DF4"
+    "AE56EDE76372BB190B07A7C8EE0A6D709E02FCE1CDF7E2ECC03404CD28342F61"
+    "9172FE9CE98583FF8E4F1232EEF28183C3FE3B1B4C6FAD733BB5FCBC2EC22005"
+    "C58EF1837D1683B2C6F34A26C1B2EFFA886B4238611FCFDCDE355B3B6519035B"
+    "BC34F4DEF99C023861B46FC9D6E6C9077AD91D2691F7F7EE598CB0FAC186D91C"
+    "AEFE130985139270B4130C93BC437944F4FD4452E2D74DD364F2E21E71F54BFF"
+    "5CAE82AB9C9DF69EE86D2BC522363A0DABC521979B0DEADA1DBF9A42D5C4484E"
+    "0ABCD06BFA53DDEF3C1B20EE3FD59D7C25E41D2B66C62E37FFFFFFFFFFFFFFFFh";
+
+// ffdhe4096, RFC 7919
+static const char kFfdhe4096Prime[] =
+    "FFFFFFFFFFFFFFFFADF85458A2BB4A9AAFDC5620273D3CF1D8B9C583CE2D3695"
+    "A9E13641146433FBCC939DCE249B3EF97D2FE363630C75D8F681B202AEC4617A"
+    "D3DF1ED5D5FD65612433F51F5F066ED0856365553DED1AF3B557135E7F57C935"
+    "984F0C70E0E68B77E2A689DAF3EFE8721DF158A136ADE73530ACCA4F483A797A"
+    "BC0AB182B324FB61D108A94BB2C8E3FBB96ADAB760D7F4681D4F42A3DE394DF4"
+    "AE56EDE76372BB190B07A7C8EE0A6D709E02FCE1CDF7E2ECC03404CD28342F61"
+    "9172FE9CE98583FF8E4F1232EEF28183C3FE3B1B4C6FAD733BB5FCBC2EC22005"
+    "C58EF1837D1683B2C6F34A26C1B2EFFA886B4238611FCFDCDE355B3B6519035B"
+    "BC34F4DEF99C023861B46FC9D6E6C9077AD91D2691F7F7EE598CB0FAC186D91C"
+    "AEFE130985139270B4130C93BC437944F4FD4452E2D74DD364F2E21E71F54BFF"
+    "5CAE82AB9C9DF69EE86D2BC522363A0DABC521979B0DEADA1DBF9A42D5C4484E"
+    "0ABCD06BFA53DDEF3C1B20EE3FD59D7C25E41D2B669E1EF16E6F52C3164DF4FB"
+    "7930E9E4E58857B6AC7D5F42D69F6D187763CF1D5503400487F55BA57E31CC7A"
+    "7135C886EFB4318AED6A1E012D9E6832A907600A918130C46DC778F971AD0038"
+    "092999A333CB8B7A1A1DB93D7140003C2A4ECEA9F98D0ACC0A8291CDCEC97DCF"
+    "8EC9B55A7F88A46B4DB5A851F44182E1C68A007E5E655F6AFFFFFFFFFFFFFFFFh";
+
+// Exponent lengths are the upper RFC 3526 estimates and the RFC 7919
+// recommendations for each group's strength
+static const NamedGroup kNamedGroups[] = {
+    {"modp2048", "RFC 3526", 2048, 320, kModp2048Prime},
+    {"modp3072", "RFC 3526", 3072, 420, kModp3072Prime},
+    {"modp4096", "RFC 3526", 4096, 480, kModp4096Prime},
+    {"ffdhe2048", "RFC 7919", 2048, 225, kFfdhe2048Prime},
+    {"ffdhe3072", "RFC 7919", 3072, 275, kFfdhe3072Prime},
+    {"ffdhe4096", "RFC 7919", 4096, 325, kFfdhe4096Prime},
+};
+
+static const size_t kNamedGroupCount = sizeof(kNamedGroups) / sizeof(kNamedGroups[0]);
+
+const std::vector<NamedGroup>& NamedGroups() {
+    static const std::vector<NamedGroup> groups(kNamedGroups, kNamedGroups + kNamedGroupCount);
+    return groups;
+}
+
+const NamedGroup* FindNamedGroup(const std::string& name) {
+    for (const NamedGroup& group : NamedGroups()) {
+        if (name == group.name) {
+            return &group;
+        }
+    }
+    return nullptr;
+}
+
+void LoadNamedGroup(const NamedGroup& group, Integer& p, Integer& q, Integer& g) {
+    p = Integer(group.prime);
+    q = (p - 1) >> 1;
+    g = Integer::Two();
+}
+
+const FixedBaseTable& NamedGroupTable(const NamedGroup& group) {
+    // One slot per built-in group, indexed by its position in NamedGroups()
+    static std::once_flag built[kNamedGroupCount];
+    static FixedBaseTable tables[kNamedGroupCount];
+    size_t index = 0;
+    while (index < kNamedGroupCount && &NamedGroups()[index] != &group) {
+        index++;
+    }
+    if (index == kNamedGroupCount) {
+        throw InvalidArgument("NamedGroupTable: not a built-in group");
+    }
+    std::call_once(built[index], [&] {
+        Integer p, q, g;
+        LoadNamedGroup(group, p, q, g);
+        tables[index].Build(g, p, group.exponentBits, kNamedGroupTeeth);
+    });
+    return tables[index];
+}
+
+void LoadGroupParameters(const std::string& source, Integer& p, Integer& q, Integer& g, size_t& exponentBits) {
+    if (const NamedGroup* group = FindNamedGroup(source)) {
+        LoadNamedGroup(*group, p, q, g);
+        exponentBits = group->exponentBits;
+        return;
+    }
+    LoadIntegersFromFile(source, p, q, g);
+    exponentBits = q.BitCount();
+}
+
+Integer RandomPrivateExponent(RandomNumberGenerator& rng, const Integer& q, size_t exponentBits) {
+    Integer limit = q - 1;
+    if (exponentBits < q.BitCount()) {
+        limit = Integer::Power2(exponentBits) - 1;
+    }
+    Integer x;
+    x.Randomize(rng, Integer::One(), limit);
+    return x;
+}
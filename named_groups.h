@@ -0,0 +1,47 @@
+#ifndef NAMED_GROUPS_H
+#define NAMED_GROUPS_H
+
+#include "fixed_base.h"
+
+// A standard safe-prime group: p = 2q + 1 with q prime and g = 2, which
+// generates the subgroup of order q. The primes are the RFC 3526 MODP and
+// RFC 7919 FFDHE groups, compiled in, so a deployment can use one without
+// searching for primes or shipping params.bin. Private exponents are
+// `exponentBits` long, the short-exponent size recommended for the group's
+// strength, rather than the full length of q.
+struct NamedGroup {
+    const char* name;
+    const char* reference;
+    size_t modulusBits;
+    size_t exponentBits;
+    const char* prime; // hexadecimal, as printed in the RFC
+};
+
+// Teeth of the comb tables built for the named groups' generators
+static const unsigned int kNamedGroupTeeth = 8;
+
+// Function to list the built-in groups
+const std::vector<NamedGroup>& NamedGroups();
+
+// Function to look up a built-in group by name; returns nullptr if there is none
+const NamedGroup* FindNamedGroup(const std::string& name);
+
+// Function to decode a built-in group's p, q and g
+void LoadNamedGroup(const NamedGroup& group, CryptoPP::Integer& p, CryptoPP::Integer& q, CryptoPP::Integer& g);
+
+// Function to get the comb table for a built-in group's generator. Each
+// table is built once per process, on first use, and shared read-only;
+// callers pass their own ModExpContext to FixedBaseTable::Exp.
+const FixedBaseTable& NamedGroupTable(const NamedGroup& group);
+
+// Function to load p, q and g from a built-in group name or else from a
+// params file; `exponentBits` is set to the private exponent length,
+// which for a params file is the length of q
+void LoadGroupParameters(const std::string& source, CryptoPP::Integer& p, CryptoPP::Integer& q, CryptoPP::Integer& g,
+                         size_t& exponentBits);
+
+// Function to draw a private exponent in [1, min(q, 2^exponentBits) - 1]
+CryptoPP::Integer RandomPrivateExponent(CryptoPP::RandomNumberGenerator& rng, const CryptoPP::Integer& q,
+                                        size_t exponentBits);
+
+#endif // NAMED_GROUPS_H
@@ -0,0 +1,123 @@
+#include "primality.h"
+#include "metrics.h"
+
+using namespace CryptoPP;
+
+// Decomposition n - 1 = d * 2^s and the Montgomery constants every round needs
+struct MillerRabinState {
+    const ModExpContext& ctx;
+    Integer d;
+    unsigned int s;
+    Integer one;       // 1 in Montgomery form
+    Integer minusOne;  // n - 1 in Montgomery form
+};
+
+// Function to run one strong probable-prime round for witness a
+static bool MillerRabinRound(const MillerRabinState& st, const Integer& a) {
+    Integer x = st.ctx.ExpMontgomery(a, st.d);
+    if (x == st.one || x == st.minusOne) return true;
+
+    for (unsigned int r = 1; r < st.s; r++) {
+        x = st.ctx.Square(x);
+        if (x == st.minusOne) return true;
+        if (x == st.one) return false;  // nontrivial square root of 1
+    }
+    return false;
+}
+
+// Function to add two residues in [0, n)
+static Integer AddMod(const Integer& a, const Integer& b, const Integer& n) {
+    Integer sum = a + b;
+    if (sum >= n) sum -= n;
+    return sum;
+}
+
+// Function to subtract two residues in [0, n)
+static Integer SubMod(const Integer& a, const Integer& b, const Integer& n) {
+    return a >= b ? a - b : a + n - b;
+}
+
+// Function to divide a residue by 2 modulo odd n; halving commutes with
+// the Montgomery factor, so it applies to Montgomery-form values as well
+static Integer HalfMod(const Integer& a, const Integer& n) {
+    return a.IsOdd() ? (a + n) >> 1 : a >> 1;
+}
+
+// Function to run the strong Lucas probable-prime test with Selfridge's
+// parameters: the first D in 5, -7, 9, -11, ... with (D/n) = -1, P = 1,
+// Q = (1 - D) / 4
+static bool StrongLucasTest(const ModExpContext& ctx, const Integer& n) {
+    long D = 5;
+    while (true) {
+        int j = Jacobi(Integer(D) % n, n);
+        if (j == -1) break;
+        if (j == 0 && Integer(D).AbsoluteValue() != n) return false;
+        // Perfect squares never yield -1; check once the search runs long
+        if (D == 13 && n.IsSquare()) return false;
+        D = D > 0 ? -(D + 2) : -D + 2;
+    }
+    long Q = (1 - D) / 4;
+
+    // n + 1 = d * 2^s
+    Integer d = n + 1;
+    unsigned int s = 0;
+    while (!d.GetBit(s)) s++;
+    d >>= s;
+
+    Integer mD = ctx.ConvertIn(Integer(D) % n);
+    Integer mQ = ctx.ConvertIn(Integer(Q) % n);
+
+    // Left-to-right ladder over d for U_k, V_k and Q^k, with P = 1
+    Integer U = ctx.One(), V = ctx.One(), Qk = mQ;
+    for (long i = long(d.BitCount()) - 2; i >= 0; i--) {
+        U = ctx.Multiply(U, V);
+        V = SubMod(ctx.Square(V), AddMod(Qk, Qk, n), n);
+        Qk = ctx.Square(Qk);
+        if (d.GetBit(i)) {
+            Integer nextU = HalfMod(AddMod(U, V, n), n);
+            V = HalfMod(AddMod(ctx.Multiply(mD, U), V, n), n);
+            U = nextU;
+            Qk = ctx.Multiply(Qk, mQ);
+        }
+    }
+
+    if (U.IsZero() || V.IsZero()) return true;
+    for (unsigned int r = 1; r < s; r++) {
+        V = SubMod(ctx.Square(V), AddMod(Qk, Qk, n), n);
+        if (V.IsZero()) return true;
+        Qk = ctx.Square(Qk);
+    }
+    return false;
+}
+
+bool PrimalityTester::IsProbablePrime(const Integer& n, RandomNumberGenerator& rng) const {
+    if (n < 2) return false;
+    if (n == 2 || n == 3) return true;
+    if (n.IsEven()) return false;
+    DH_METRIC_COUNT("dh_primality_tests_total", "Odd candidates given a probable-prime test", 1);
+
+    // One Montgomery context serves every round for this candidate
+    ModExpContext ctx(n);
+    MillerRabinState st = {ctx, n - 1, 0, ctx.One(), ctx.ConvertIn(n - 1)};
+    while (!st.d.GetBit(st.s)) st.s++;
+    st.d >>= st.s;
+
+    if (m_mode == PrimalityMode::BailliePSW) {
+        DH_METRIC_COUNT("dh_lucas_tests_total", "Baillie-PSW base-2 plus strong Lucas tests run", 1);
+        if (!MillerRabinRound(st, Integer::Two()) || !StrongLucasTest(ctx, n)) return false;
+    }
+
+    Integer a;
+    for (unsigned int i = 0; i < m_rounds; i++) {
+        a.Randomize(rng, 2, n - 2);  // Random witness in range [2, n-2]
+        DH_METRIC_COUNT("dh_miller_rabin_rounds_total", "Random-witness Miller-Rabin rounds run", 1);
+        if (!MillerRabinRound(st, a)) return false;
+    }
+
+    return true;
+}
+
+// Function to perform Miller-Rabin primality test
+bool IsProbablePrime(const Integer& n, RandomNumberGenerator& rng, unsigned int rounds) {
+    return PrimalityTester(PrimalityMode::MillerRabin, rounds).IsProbablePrime(n, rng);
+}
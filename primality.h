@@ -0,0 +1,36 @@
+#ifndef PRIMALITY_H
+#define PRIMALITY_H
+
+#include "mod_exp.h"
+
+// Which probable-prime test a PrimalityTester runs
+enum class PrimalityMode {
+    MillerRabin,  // `rounds` Miller-Rabin rounds with random witnesses
+    BailliePSW    // strong base-2 round plus strong Lucas test, then `rounds` random rounds
+};
+
+// Primality engine for candidate testing. All rounds for one candidate
+// share a single Montgomery context, witnesses stay in Montgomery form and
+// the squaring chain runs in place with a machine-word counter. Baillie-PSW
+// has no known counterexample, so it needs far fewer random Miller-Rabin
+// rounds for the same confidence.
+class PrimalityTester {
+public:
+    explicit PrimalityTester(PrimalityMode mode = PrimalityMode::MillerRabin, unsigned int rounds = 10)
+        : m_mode(mode), m_rounds(rounds) {}
+
+    // Function to test whether n is a probable prime
+    bool IsProbablePrime(const CryptoPP::Integer& n, CryptoPP::RandomNumberGenerator& rng) const;
+
+    PrimalityMode Mode() const { return m_mode; }
+    unsigned int Rounds() const { return m_rounds; }
+
+private:
+    PrimalityMode m_mode;
+    unsigned int m_rounds;
+};
+
+// Function to perform Miller-Rabin primality test
+bool IsProbablePrime(const CryptoPP::Integer& n, CryptoPP::RandomNumberGenerator& rng, unsigned int rounds = 10);
+
+#endif // PRIMALITY_H
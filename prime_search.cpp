@@ -0,0 +1,241 @@
+#include "prime_search.h"
+#include "metrics.h"
+#include "cpu_dispatch.h"
+
+using namespace CryptoPP;
+
+// Separate DRBG streams so q, p and later draws never share candidates
+static const unsigned long long kPrimeStream = 1;
+static const unsigned long long kConditionStream = 2;
+
+// Candidates examined from one random starting point before drawing a new one
+static const size_t kRunLength = 4096;
+
+// Candidates this short may equal a sieving prime, so they skip the sieve
+static const unsigned int kSieveMinBits = 16;
+
+// One unit of work: candidates base + j * step for j < count
+struct CandidateRun {
+    Integer base;
+    Integer step;
+    size_t count;
+};
+
+typedef std::function<CandidateRun(RandomNumberGenerator&)> RunFunction;
+
+// Function to list the odd primes below 2^13 used for trial division
+static const std::vector<word32>& SmallPrimes() {
+    static const std::vector<word32> primes = [] {
+        const word32 limit = 1 << 13;
+        std::vector<bool> composite(limit, false);
+        std::vector<word32> result;
+        for (word32 n = 3; n < limit; n += 2) {
+            if (composite[n]) continue;
+            result.push_back(n);
+            for (word32 m = n * n; m < limit; m += 2 * n) composite[m] = true;
+        }
+        return result;
+    }();
+    return primes;
+}
+
+// Function to report whether a small prime divides the current candidate,
+// first stepping every residue to it when advance is set. Branch-free so
+// the loop vectorizes, wider in each ISA-level clone.
+DH_KERNEL_CLONES static bool SieveResidues(word32* residues, const word32* stepResidues, const word32* primes,
+                                           size_t count, bool advance) {
+    word32 zero = 0;
+    if (advance) {
+        for (size_t i = 0; i < count; i++) {
+            word32 r = residues[i] + stepResidues[i];
+            r -= r >= primes[i] ? primes[i] : 0;
+            residues[i] = r;
+            zero |= r == 0;
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            zero |= residues[i] == 0;
+        }
+    }
+    return zero != 0;
+}
+
+// Function to cap a run so base + j * step stays at or below limit
+static size_t RunLength(const Integer& base, const Integer& step, const Integer& limit) {
+    Integer steps = (limit - base) / step + 1;
+    if (steps.IsNegative() || steps.IsZero()) return 0;
+    return steps > Integer(long(kRunLength)) ? kRunLength : size_t(steps.ConvertToLong());
+}
+
+// Function to create the random source for one numbered stream of a seeded run
+std::unique_ptr<RandomNumberGenerator> MakeSeededRng(unsigned long long seed, unsigned long long stream,
+                                                     unsigned long long index) {
+    // Expand the seed to a full-strength entropy input; stream and index
+    // become the DRBG nonce, in a fixed byte order for every host
+    byte seedBytes[8], entropy[SHA256::DIGESTSIZE], nonce[16];
+    for (int i = 0; i < 8; i++) {
+        seedBytes[i] = byte(seed >> (8 * i));
+        nonce[i] = byte(stream >> (8 * i));
+        nonce[8 + i] = byte(index >> (8 * i));
+    }
+    SHA256().CalculateDigest(entropy, seedBytes, sizeof(seedBytes));
+    return std::unique_ptr<RandomNumberGenerator>(new Hash_DRBG<SHA256>(entropy, sizeof(entropy), nonce, sizeof(nonce)));
+}
+
+// Function to test numbered runs of candidates on worker threads until a prime is found
+static Integer ParallelPrimeSearch(const RunFunction& makeRun, unsigned int rounds, unsigned long long stream,
+                                   const PrimeSearchOptions& options, PrimeSearchStats* stats) {
+    DH_METRIC_TIME("dh_prime_search_seconds", "Wall time of one prime search, q or p");
+    // Baillie-PSW backs its base-2 and Lucas tests with one random round
+    PrimalityTester tester = options.primality == PrimalityMode::BailliePSW
+                                 ? PrimalityTester(PrimalityMode::BailliePSW, 1)
+                                 : PrimalityTester(PrimalityMode::MillerRabin, rounds);
+    const unsigned long long none = std::numeric_limits<unsigned long long>::max();
+    const std::vector<word32>& smallPrimes = SmallPrimes();
+    std::atomic<unsigned long long> nextIndex(0), bestIndex(none);
+    std::atomic<unsigned long long> examined(0), sieveRejected(0), tested(0), rejected(0);
+    std::mutex resultMutex;
+    Integer result;
+    std::exception_ptr failure;
+
+    auto worker = [&]() {
+        try {
+            AutoSeededRandomPool pool;
+            std::vector<word32> residues(smallPrimes.size()), stepResidues(smallPrimes.size());
+            while (true) {
+                unsigned long long index = nextIndex++;
+                // A seeded run still finishes every unit numbered below the
+                // best prime so far; an unseeded run stops at the first
+                auto cancelled = [&] {
+                    return index >= bestIndex || (!options.deterministic && bestIndex != none);
+                };
+                if (cancelled()) {
+                    return;
+                }
+
+                std::unique_ptr<RandomNumberGenerator> seeded;
+                if (options.deterministic) {
+                    seeded = MakeSeededRng(options.seed, stream, index);
+                }
+                RandomNumberGenerator& rng = seeded ? *seeded : pool;
+
+                CandidateRun run = makeRun(rng);
+                bool sieve = run.base.BitCount() > kSieveMinBits;
+                if (sieve) {
+                    for (size_t i = 0; i < smallPrimes.size(); i++) {
+                        residues[i] = word32(run.base.Modulo(word(smallPrimes[i])));
+                        stepResidues[i] = word32(run.step.Modulo(word(smallPrimes[i])));
+                    }
+                }
+
+                Integer candidate = run.base;
+                for (size_t j = 0; j < run.count && !cancelled(); j++) {
+                    // Advance every residue with the candidate; a zero residue
+                    // means a small prime divides it
+                    bool divisible = false;
+                    if (j != 0) {
+                        candidate += run.step;
+                    }
+                    if (sieve) {
+                        divisible = SieveResidues(residues.data(), stepResidues.data(), smallPrimes.data(),
+                                                  smallPrimes.size(), j != 0);
+                    }
+
+                    examined++;
+                    if (divisible) {
+                        sieveRejected++;
+                        continue;
+                    }
+                    tested++;
+                    if (!tester.IsProbablePrime(candidate, rng)) {
+                        rejected++;
+                        continue;
+                    }
+
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    if (index < bestIndex) {
+                        bestIndex = index;
+                        result = candidate;
+                    }
+                    break;
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            failure = std::current_exception();
+            bestIndex = 0;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < std::max(1u, options.threads); i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    DH_METRIC_COUNT("dh_prime_candidates_total", "Prime search candidates examined", examined);
+    DH_METRIC_COUNT("dh_prime_sieve_rejected_total", "Candidates rejected by trial division", sieveRejected);
+    DH_METRIC_COUNT("dh_prime_tested_total", "Candidates that reached the probable-prime test", tested);
+    DH_METRIC_COUNT("dh_prime_test_rejected_total", "Candidates the probable-prime test rejected", rejected);
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    if (stats) {
+        stats->candidates = examined;
+        stats->sieveRejected = sieveRejected;
+        stats->millerRabinTested = tested;
+        stats->millerRabinRejected = rejected;
+        stats->seconds = std::chrono::duration<double>(end - start).count();
+    }
+    return result;
+}
+
+// Function to generate a prime number with the specified number of bits
+Integer GeneratePrime(size_t numBits, const PrimeSearchOptions& options, PrimeSearchStats* stats) {
+    if (numBits < 2) {
+        throw InvalidArgument("GeneratePrime: at least 2 bits are required");
+    }
+
+    // Odd candidates from a random start up to the largest numBits-bit number
+    Integer limit = Integer::Power2(numBits) - 1;
+    auto makeRun = [&](RandomNumberGenerator& rng) {
+        CandidateRun run;
+        run.base.Randomize(rng, numBits);
+        run.base.SetBit(numBits - 1);
+        run.base.SetBit(0);
+        run.step = 2;
+        run.count = RunLength(run.base, run.step, limit);
+        return run;
+    };
+    return ParallelPrimeSearch(makeRun, 10, kPrimeStream, options, stats);
+}
+
+// Function to generate a numBits-bit prime p where p - 1 is divisible by q
+Integer GeneratePrimeWithCondition(size_t numBits, const Integer& q, const PrimeSearchOptions& options, PrimeSearchStats* stats) {
+    if (numBits <= q.BitCount() + 1) {
+        throw InvalidArgument("GeneratePrimeWithCondition: p must be at least two bits longer than q");
+    }
+
+    // p = 2kq + 1 stays odd; k is drawn so that p has exactly numBits bits,
+    // and advancing k by one moves p by 2q
+    Integer twoQ = q << 1;
+    Integer kMin = (Integer::Power2(numBits - 1) + twoQ - 1) / twoQ;
+    Integer kMax = (Integer::Power2(numBits) - 2) / twoQ;
+    Integer limit = kMax * twoQ + 1;
+
+    auto makeRun = [&](RandomNumberGenerator& rng) {
+        Integer k;
+        k.Randomize(rng, kMin, kMax);
+        CandidateRun run;
+        run.base = k * twoQ + 1;
+        run.step = twoQ;
+        run.count = RunLength(run.base, run.step, limit);
+        return run;
+    };
+    return ParallelPrimeSearch(makeRun, 20, kConditionStream, options, stats);
+}
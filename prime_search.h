@@ -0,0 +1,44 @@
+#ifndef PRIME_SEARCH_H
+#define PRIME_SEARCH_H
+
+#include "primality.h"
+
+// How a prime search spreads work over threads. Each unit of work is a
+// random starting point followed by a run of candidates stepping towards
+// the next prime. With deterministic set, unit i is drawn from a Hash_DRBG
+// keyed by (seed, i) and the lowest-numbered unit holding a prime wins, so
+// a seed yields the same prime for any thread count. Otherwise each thread
+// draws from its own auto-seeded pool and the first verified prime stops
+// the search.
+struct PrimeSearchOptions {
+    unsigned int threads = 1;
+    bool deterministic = false;
+    unsigned long long seed = 0;
+    PrimalityMode primality = PrimalityMode::MillerRabin;
+};
+
+// Counters reported by a finished search. Every candidate first goes
+// through trial division by the small-prime sieve; only survivors pay for
+// Miller-Rabin exponentiations.
+struct PrimeSearchStats {
+    unsigned long long candidates = 0;
+    unsigned long long sieveRejected = 0;
+    unsigned long long millerRabinTested = 0;
+    unsigned long long millerRabinRejected = 0;
+    double seconds = 0;
+
+    double CandidatesPerSecond() const { return seconds > 0 ? candidates / seconds : 0; }
+};
+
+// Function to generate a prime number with the specified number of bits
+CryptoPP::Integer GeneratePrime(size_t numBits, const PrimeSearchOptions& options, PrimeSearchStats* stats = nullptr);
+
+// Function to generate a numBits-bit prime p where p - 1 is divisible by q
+CryptoPP::Integer GeneratePrimeWithCondition(size_t numBits, const CryptoPP::Integer& q, const PrimeSearchOptions& options,
+                                             PrimeSearchStats* stats = nullptr);
+
+// Function to create the random source for one numbered stream of a seeded run
+std::unique_ptr<CryptoPP::RandomNumberGenerator> MakeSeededRng(unsigned long long seed, unsigned long long stream,
+                                                               unsigned long long index);
+
+#endif // PRIME_SEARCH_H
@@ -0,0 +1,87 @@
+#include "secret_exp.h"
+#include "fixed_bignum.h"
+#include "metrics.h"
+
+using namespace CryptoPP;
+
+// Fixed-width engine behind SecretExpContext, one instantiation per limb count
+class SecretExpEngine {
+public:
+    virtual ~SecretExpEngine() {}
+    virtual Integer Exp(const Integer& base, const Integer& exponent, size_t exponentBits) const = 0;
+    virtual size_t Limbs() const = 0;
+};
+
+// Function to run the fixed-width ladder; a plain overload per limb count
+// so each can be cloned per ISA level
+#define FIXED_EXP_KERNEL(L)                                                                    \
+    DH_KERNEL_CLONES static void FixedExp(const FixedMontgomery<L>& montgomery, FixedUInt<L>& r, \
+                                          const FixedUInt<L>& base, const FixedUInt<L>& exponent,  \
+                                          size_t exponentBits) {                                  \
+        montgomery.Exp(r, base, exponent, exponentBits);                                          \
+    }
+FIXED_EXP_KERNEL(16)
+FIXED_EXP_KERNEL(32)
+FIXED_EXP_KERNEL(48)
+FIXED_EXP_KERNEL(64)
+#undef FIXED_EXP_KERNEL
+
+template <size_t L>
+class FixedSecretExpEngine : public SecretExpEngine {
+public:
+    explicit FixedSecretExpEngine(const Integer& modulus) : m_montgomery(modulus) {}
+
+    Integer Exp(const Integer& base, const Integer& exponent, size_t exponentBits) const override {
+        FixedUInt<L> b, e, r;
+        b.FromInteger(base);
+        e.FromInteger(exponent);
+        FixedExp(m_montgomery, r, b, e, exponentBits);
+        return r.ToInteger();
+    }
+
+    size_t Limbs() const override { return L; }
+
+private:
+    FixedMontgomery<L> m_montgomery;
+};
+
+size_t FixedWidthLimbs(const Integer& modulus) {
+    if (modulus.IsEven() || modulus < 3) return 0;
+    size_t bits = modulus.BitCount();
+    if (bits <= 1024) return 16;
+    if (bits <= 2048) return 32;
+    if (bits <= 3072) return 48;
+    if (bits <= 4096) return 64;
+    return 0;
+}
+
+SecretExpContext::SecretExpContext(const Integer& modulus) : m_modulus(modulus) {
+    switch (FixedWidthLimbs(modulus)) {
+    case 16: m_engine.reset(new FixedSecretExpEngine<16>(modulus)); break;
+    case 32: m_engine.reset(new FixedSecretExpEngine<32>(modulus)); break;
+    case 48: m_engine.reset(new FixedSecretExpEngine<48>(modulus)); break;
+    case 64: m_engine.reset(new FixedSecretExpEngine<64>(modulus)); break;
+    default: m_fallback.reset(new ModExpContext(modulus)); break;
+    }
+}
+
+SecretExpContext::~SecretExpContext() {}
+
+Integer SecretExpContext::Exp(const Integer& base, const Integer& exponent, size_t exponentBits) const {
+    DH_METRIC_TIME("dh_secret_exp_seconds", "Time in constant-time private-key exponentiation");
+    if (exponentBits == 0) {
+        exponentBits = m_modulus.BitCount();
+    }
+    if (exponent.IsNegative() || exponent.BitCount() > exponentBits) {
+        throw InvalidArgument("SecretExpContext: exponent longer than " + std::to_string(exponentBits) + " bits");
+    }
+    if (!m_engine) {
+        return m_fallback->Exp(base, exponent);
+    }
+    // The base is public (a generator or a peer's key), so reducing it may branch
+    return m_engine->Exp(base % m_modulus, exponent, exponentBits);
+}
+
+size_t SecretExpContext::Limbs() const {
+    return m_engine ? m_engine->Limbs() : 0;
+}
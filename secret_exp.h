@@ -0,0 +1,41 @@
+#ifndef SECRET_EXP_H
+#define SECRET_EXP_H
+
+#include "mod_exp.h"
+
+class SecretExpEngine;
+
+// Modular exponentiation for secret exponents such as private keys. An
+// odd modulus of up to 1024, 2048, 3072 or 4096 bits is dispatched to
+// FixedMontgomery (see fixed_bignum.h) with 16, 32, 48 or 64 limbs, which
+// keeps every operand on the stack and runs in time that depends only on
+// the modulus size and the declared exponent length. Other moduli fall
+// back to the variable-time ModExpContext. Build one context per modulus
+// and per thread, like ModExpContext.
+class SecretExpContext {
+public:
+    explicit SecretExpContext(const CryptoPP::Integer& modulus);
+    ~SecretExpContext();
+
+    SecretExpContext(const SecretExpContext&) = delete;
+    SecretExpContext& operator=(const SecretExpContext&) = delete;
+
+    // Function to compute base^exponent mod modulus for an exponent below
+    // 2^exponentBits (0 means the modulus length); throws if it is longer
+    CryptoPP::Integer Exp(const CryptoPP::Integer& base, const CryptoPP::Integer& exponent, size_t exponentBits) const;
+
+    bool IsConstantTime() const { return m_engine != nullptr; }
+    size_t Limbs() const;
+    const CryptoPP::Integer& GetModulus() const { return m_modulus; }
+
+private:
+    CryptoPP::Integer m_modulus;
+    std::unique_ptr<SecretExpEngine> m_engine;
+    std::unique_ptr<ModExpContext> m_fallback;
+};
+
+// Function to get the limb count SecretExpContext uses for a modulus, or 0
+// if it falls back to the variable-time engine
+size_t FixedWidthLimbs(const CryptoPP::Integer& modulus);
+
+#endif // SECRET_EXP_H
@@ -0,0 +1,85 @@
+#include "session_kdf.h"
+#include "metrics.h"
+
+using namespace CryptoPP;
+
+// HKDF may expand at most 255 blocks per output
+static const size_t kMaxKdfLength = 255 * SHA256::DIGESTSIZE;
+
+SessionKdf::SessionKdf(const std::vector<KdfOutput>& outputs, const std::string& salt)
+    : m_outputs(outputs), m_outputLength(0) {
+    if (outputs.empty()) {
+        throw InvalidArgument("SessionKdf: no outputs configured");
+    }
+    for (const KdfOutput& output : outputs) {
+        if (output.length == 0 || output.length > kMaxKdfLength) {
+            throw InvalidArgument("SessionKdf: output " + output.label + " must be 1 to " +
+                                  std::to_string(kMaxKdfLength) + " bytes");
+        }
+        m_outputLength += output.length;
+    }
+    if (salt.empty()) {
+        m_salt.CleanNew(SHA256::DIGESTSIZE);
+    } else {
+        m_salt.resize(salt.size());
+        std::memcpy(m_salt.data(), salt.data(), salt.size());
+    }
+}
+
+void SessionKdf::Derive(const byte* secret, size_t secretLength, byte* keys) const {
+    DeriveBatch(secret, secretLength, 1, keys);
+}
+
+void SessionKdf::DeriveBatch(const byte* secrets, size_t secretLength, size_t count, byte* keys) const {
+    DH_METRIC_TIME("dh_kdf_seconds", "Time expanding session keys from shared secrets");
+    DH_METRIC_COUNT("dh_kdf_secrets_total", "Shared secrets run through the KDF", count);
+    // Extract is keyed by the salt for the whole batch; Final restarts
+    // it keyed, and expand is re-keyed with each secret's PRK in place
+    HMAC<SHA256> extract(m_salt.data(), m_salt.size());
+    HMAC<SHA256> expand;
+    byte prk[SHA256::DIGESTSIZE], block[SHA256::DIGESTSIZE];
+
+    for (size_t n = 0; n < count; n++) {
+        // Extract: PRK = HMAC(salt, secret)
+        extract.CalculateDigest(prk, secrets + n * secretLength, secretLength);
+        expand.SetKey(prk, sizeof(prk));
+
+        // Expand each label: T(i) = HMAC(PRK, T(i-1) || label || i)
+        byte* out = keys + n * m_outputLength;
+        for (const KdfOutput& output : m_outputs) {
+            size_t done = 0;
+            for (byte counter = 1; done < output.length; counter++) {
+                if (counter > 1) {
+                    expand.Update(block, sizeof(block));
+                }
+                expand.Update(reinterpret_cast<const byte*>(output.label.data()), output.label.size());
+                expand.Update(&counter, 1);
+                expand.Final(block);
+                size_t take = std::min(sizeof(block), output.length - done);
+                std::memcpy(out + done, block, take);
+                done += take;
+            }
+            out += output.length;
+        }
+    }
+    SecureWipeBuffer(prk, sizeof(prk));
+    SecureWipeBuffer(block, sizeof(block));
+}
+
+KdfOutput ParseKdfOutput(const std::string& spec) {
+    KdfOutput output = {spec, kDefaultKdfLength};
+    size_t colon = spec.rfind(':');
+    if (colon != std::string::npos) {
+        output.label = spec.substr(0, colon);
+        try {
+            size_t used = 0;
+            output.length = std::stoul(spec.substr(colon + 1), &used);
+            if (used != spec.size() - colon - 1) {
+                throw std::invalid_argument(spec);
+            }
+        } catch (const std::logic_error&) {
+            throw InvalidArgument("Bad KDF output " + spec + "; expected <label>:<bytes>");
+        }
+    }
+    return output;
+}
@@ -0,0 +1,53 @@
+#ifndef SESSION_KDF_H
+#define SESSION_KDF_H
+
+#include "crypto_headers.h"
+
+// One sub-key expanded from each shared secret: a context label, used as
+// the HKDF info, and the key length in bytes
+struct KdfOutput {
+    std::string label;
+    size_t length;
+};
+
+// Default output of sessionKeyGen: one 32-byte key
+static const char kDefaultKdfLabel[] = "dh session key";
+static const size_t kDefaultKdfLength = 32;
+
+// HKDF-SHA256 (RFC 5869) from a Diffie-Hellman shared secret to
+// fixed-length session keys. Each secret is extracted once into a
+// pseudorandom key, then every configured sub-key is expanded from it
+// under its own label and written back to back, in order, so one
+// exchange yields OutputLength() bytes. The secret is the group's
+// fixed-length agreed value (KeyAgreementBackend::AgreedValueLength).
+// Derivation never allocates per key: the HMAC state is keyed once per
+// call and re-keyed in place for each secret of a batch.
+class SessionKdf {
+public:
+    // Function to configure the sub-keys; an empty salt means RFC 5869's
+    // default of 32 zero bytes. Throws if an output is empty or longer
+    // than HKDF allows (255 * 32 bytes).
+    explicit SessionKdf(const std::vector<KdfOutput>& outputs, const std::string& salt = "");
+
+    // Function to derive every sub-key for one secret into `keys`, which
+    // must hold OutputLength() bytes
+    void Derive(const CryptoPP::byte* secret, size_t secretLength, CryptoPP::byte* keys) const;
+
+    // Function to derive for `count` secrets of `secretLength` bytes each,
+    // stored back to back; keys for secret i start at i * OutputLength()
+    void DeriveBatch(const CryptoPP::byte* secrets, size_t secretLength, size_t count, CryptoPP::byte* keys) const;
+
+    size_t OutputLength() const { return m_outputLength; }
+    const std::vector<KdfOutput>& Outputs() const { return m_outputs; }
+
+private:
+    std::vector<KdfOutput> m_outputs;
+    CryptoPP::SecByteBlock m_salt;
+    size_t m_outputLength;
+};
+
+// Function to parse a "label:bytes" output, or a bare label of
+// kDefaultKdfLength bytes
+KdfOutput ParseKdfOutput(const std::string& spec);
+
+#endif // SESSION_KDF_H
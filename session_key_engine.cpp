@@ -0,0 +1,122 @@
+#include "session_key_engine.h"
+#include "certificate.h"
+
+using namespace CryptoPP;
+
+// Jobs claimed per trip to the shared counter
+static const size_t kJobChunk = 4;
+
+SessionKeyEngine::SessionKeyEngine(const Integer& p, unsigned int threads, size_t exponentBits, BatchKernel kernel)
+    : m_modulus(p), m_exponentBits(exponentBits), m_kernel(BatchKernel::Portable), m_jobs(nullptr), m_results(nullptr), m_next(0), m_busy(0), m_generation(0), m_stop(false) {
+    if (threads == 0) {
+        throw InvalidArgument("SessionKeyEngine: at least one thread is required");
+    }
+    // The lanes cover the same moduli as the fixed-width scalar engine
+    if (FixedWidthLimbs(p) != 0) {
+        m_kernel = kernel == BatchKernel::Auto ? DetectBatchKernel() : kernel;
+        // Reject a kernel this CPU lacks here rather than inside a worker
+        BatchExpContext probe(p, m_kernel);
+    }
+    for (unsigned int i = 0; i < threads; i++) {
+        m_workers.emplace_back(&SessionKeyEngine::WorkerLoop, this);
+    }
+}
+
+SessionKeyEngine::~SessionKeyEngine() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_workReady.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void SessionKeyEngine::Derive(const std::vector<SessionKeyJob>& jobs, std::vector<SessionKeyResult>& results) {
+    results.assign(jobs.size(), SessionKeyResult());
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobs = &jobs;
+    m_results = &results;
+    m_next = 0;
+    m_busy = unsigned(m_workers.size());
+    m_generation++;
+    m_workReady.notify_all();
+    m_workDone.wait(lock, [this] { return m_busy == 0; });
+    m_jobs = nullptr;
+    m_results = nullptr;
+}
+
+void SessionKeyEngine::WorkerLoop() {
+    // Per-thread scratch: constant-time Montgomery context for p, and the
+    // lane buffers when a vector kernel is in use
+    SecretExpContext ctx(m_modulus);
+    std::unique_ptr<BatchExpContext> batch;
+    if (m_kernel != BatchKernel::Portable) {
+        batch.reset(new BatchExpContext(m_modulus, m_kernel));
+    }
+    const size_t chunk = batch ? std::max(kJobChunk, batch->Lanes()) : kJobChunk;
+    const size_t exponentBits = m_exponentBits ? m_exponentBits : m_modulus.BitCount();
+    std::vector<Integer> bases, exponents, keys;
+    std::vector<size_t> slots;
+    Integer upperBound = m_modulus - 1;
+    unsigned long seen = 0;
+
+    while (true) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_workReady.wait(lock, [&] { return m_stop || m_generation != seen; });
+        if (m_stop) {
+            return;
+        }
+        seen = m_generation;
+        const std::vector<SessionKeyJob>& jobs = *m_jobs;
+        std::vector<SessionKeyResult>& results = *m_results;
+        lock.unlock();
+
+        while (true) {
+            size_t begin = m_next.fetch_add(chunk);
+            if (begin >= jobs.size()) {
+                break;
+            }
+            size_t end = std::min(begin + chunk, jobs.size());
+            bases.clear();
+            exponents.clear();
+            slots.clear();
+            for (size_t i = begin; i < end; i++) {
+                try {
+                    Integer peerKey = CertificatePublicKey(jobs[i].certificate);
+                    // Reject 0, 1 and p-1, which would pin the shared secret
+                    if (peerKey <= Integer::One() || peerKey >= upperBound) {
+                        throw std::runtime_error("Peer public key out of range");
+                    }
+                    if (!batch) {
+                        results[i].sessionKey = ctx.Exp(peerKey, jobs[i].privateKey, m_exponentBits);
+                        continue;
+                    }
+                    // Checked here so one bad key fails its own job, not the whole chunk
+                    if (jobs[i].privateKey.IsNegative() || jobs[i].privateKey.BitCount() > exponentBits) {
+                        throw InvalidArgument("SessionKeyEngine: private key longer than " +
+                                              std::to_string(exponentBits) + " bits");
+                    }
+                    bases.push_back(peerKey);
+                    exponents.push_back(jobs[i].privateKey);
+                    slots.push_back(i);
+                } catch (const std::exception& e) {
+                    results[i].error = e.what();
+                }
+            }
+            if (!slots.empty()) {
+                batch->Exp(bases, exponents, exponentBits, keys);
+                for (size_t k = 0; k < slots.size(); k++) {
+                    results[slots[k]].sessionKey = keys[k];
+                }
+            }
+        }
+
+        lock.lock();
+        if (--m_busy == 0) {
+            m_workDone.notify_all();
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef SESSION_KEY_ENGINE_H
+#define SESSION_KEY_ENGINE_H
+
+#include "batch_exp.h"
+#include "secret_exp.h"
+
+// One session-key derivation: the peer's certificate text and our private key
+struct SessionKeyJob {
+    std::string certificate;
+    CryptoPP::Integer privateKey;
+};
+
+// Derived shared secret, or the reason the job failed
+struct SessionKeyResult {
+    CryptoPP::Integer sessionKey;
+    std::string error;
+};
+
+// Fixed pool of worker threads deriving session keys modulo one p.
+// Each worker owns a SecretExpContext for p, so the Montgomery constants
+// are built once per thread and reused for every job. Private keys must
+// be below 2^exponentBits (0 means the length of p); every derivation
+// takes the same time for a given exponent length.
+// When the CPU has a vector kernel for p (see batch_exp.h), each worker
+// also owns a BatchExpContext and derives a whole chunk of jobs in one
+// pass, one job per lane; BatchKernel::Portable keeps every worker on the
+// scalar engine, which beats the portable lanes.
+// Workers claim small chunks of a batch from a shared counter, so a
+// thread that draws cheap jobs keeps pulling work until the batch drains.
+class SessionKeyEngine {
+public:
+    SessionKeyEngine(const CryptoPP::Integer& p, unsigned int threads, size_t exponentBits = 0,
+                     BatchKernel kernel = BatchKernel::Auto);
+    ~SessionKeyEngine();
+
+    SessionKeyEngine(const SessionKeyEngine&) = delete;
+    SessionKeyEngine& operator=(const SessionKeyEngine&) = delete;
+
+    // Function to derive every job in the batch; blocks until all are done
+    void Derive(const std::vector<SessionKeyJob>& jobs, std::vector<SessionKeyResult>& results);
+
+    unsigned int Threads() const { return unsigned(m_workers.size()); }
+    BatchKernel Kernel() const { return m_kernel; }
+
+private:
+    void WorkerLoop();
+
+    CryptoPP::Integer m_modulus;
+    size_t m_exponentBits;
+    BatchKernel m_kernel;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workReady;
+    std::condition_variable m_workDone;
+    const std::vector<SessionKeyJob>* m_jobs;
+    std::vector<SessionKeyResult>* m_results;
+    std::atomic<size_t> m_next;
+    unsigned int m_busy;
+    unsigned long m_generation;
+    bool m_stop;
+};
+
+#endif // SESSION_KEY_ENGINE_H
@@ -0,0 +1,102 @@
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Bounded multi-producer, multi-consumer queue connecting pipeline stages.
+// Push blocks while the queue is full, so a fast stage cannot run ahead of
+// a slow one by more than `capacity` items. Close() wakes everyone: pushes
+// fail from then on, and pops drain what is left before returning false.
+template <typename T>
+class WorkQueue {
+public:
+    explicit WorkQueue(size_t capacity) : m_capacity(capacity ? capacity : 1), m_closed(false) {}
+
+    WorkQueue(const WorkQueue&) = delete;
+    WorkQueue& operator=(const WorkQueue&) = delete;
+
+    // Function to add an item; returns false if the queue was closed
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+        if (m_closed) {
+            return false;
+        }
+        m_items.push_back(std::move(item));
+        lock.unlock();
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    // Function to take the oldest item; returns false once the queue is closed and empty
+    bool Pop(T& item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+        if (m_items.empty()) {
+            return false;
+        }
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        lock.unlock();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    // Function to take an item without waiting; returns false if none is queued
+    bool TryPop(T& item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_items.empty()) {
+            return false;
+        }
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        lock.unlock();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    // Function to wait for at least one item and take everything queued,
+    // so a consumer pays for one lock round trip per burst instead of per
+    // item; returns false once the queue is closed and empty
+    bool PopAll(std::deque<T>& items) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+        if (m_items.empty()) {
+            return false;
+        }
+        items.swap(m_items);
+        m_items.clear();
+        lock.unlock();
+        m_notFull.notify_all();
+        return true;
+    }
+
+    // Function to stop accepting items and wake every waiting thread
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+    size_t Size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_items.size();
+    }
+
+    size_t Capacity() const { return m_capacity; }
+
+private:
+    const size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+    std::deque<T> m_items;
+    bool m_closed;
+};
+
+#endif // WORK_QUEUE_H